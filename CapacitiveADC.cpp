@@ -23,15 +23,36 @@
 // We initialize global settings once for all instances.
 CapADCSetGlobal_t CapADC::_gSettings = CapADCSetGlobal_t();
 
+CapADCRing<CapADCEvent_t, CAP_ADC_EVENT_QUEUE_SIZE> CapADC::_events;
+uint16_t CapADC::_lostEvents = 0;
+
+// Constructor
+CapADC::CapADC():_resetCounter(CapADCConfigLocal::resetCounter), _tuneState(TuneIdle), _tuneStart(0), _tuneBaselineLength(0), _tuneThresholdLength(0),
+				_onTouch(0), _onRelease(0), _onLongPress(0), _onSlide(0),
+				_longPressDelay(0), _touchStart(0), _touching(false){
+#if CAP_ADC_TELEMETRY
+	_telemetryId = CapADCTelemetry::NoId;
+#endif
+}
 
 // Set touch threshold
 void CapADC::setTouchThreshold(uint16_t threshold){
-	_lSettings.touchThreshold = threshold;
+	storeTouchThreshold(threshold);
 }
 
 // Set untouch threshold
 void CapADC::setReleaseThreshold(uint16_t threshold){
-	_lSettings.releaseThreshold = threshold;
+	storeReleaseThreshold(threshold);
+}
+
+// Set proximity threshold. 0 disables proximity detection.
+void CapADC::setProxThreshold(uint16_t threshold){
+	storeProxThreshold(threshold);
+}
+
+// Set unprox threshold. It should be under the prox threshold, the difference being the hysteresis.
+void CapADC::setProxReleaseThreshold(uint16_t threshold){
+	storeProxReleaseThreshold(threshold);
 }
 
 // This is how we acceed to global setting (that all instances share),
@@ -49,16 +70,287 @@ CapADCSetGlobal_t CapADC::getGlobalSettings()const{
 	return _gSettings;
 }
 
-// Same for the local settings (threshold and reset delay). Getter
+// Same for the local settings (threshold and reset delay).
+// Thresholds are kept as they are when fixed, see CapADCThresholds.
 void CapADC::applyLocalSettings(const CapADCSetLocal_t& settings){
-	_lSettings = settings;
+	storeTouchThreshold(settings.touchThreshold);
+	storeReleaseThreshold(settings.releaseThreshold);
+	storeProxThreshold(settings.proxThreshold);
+	storeProxReleaseThreshold(settings.proxReleaseThreshold);
+	_resetCounter = settings.resetCounter;
 }
 
-// And setter, that we use once we have modified the values.
-CapADCSetLocal_t* CapADC::localSettings(){
-	return &_lSettings;
+CapADCSetLocal_t CapADC::getLocalSettings()const{
+	return CapADCSetLocal_t(localTouchThreshold(), localReleaseThreshold(), _resetCounter,
+							localProxThreshold(), localProxReleaseThreshold());
 }
 
-CapADCSetLocal_t CapADC::getLocalSettings()const{
-	return _lSettings;
+// Tells if a tuning is running. While it does, update() feeds it instead of detecting touch.
+bool CapADC::isTuning() const{
+	return _tuneState != TuneIdle;
+}
+
+// Progress of the running tuning, from 0 to 100. 100 when no tuning is running.
+uint8_t CapADC::getTuneProgress() const{
+	if(_tuneState == TuneIdle) return 100;
+
+	uint32_t total = _tuneBaselineLength + _tuneThresholdLength;
+	uint32_t elapsed = tuneElapsed();
+	if(total == 0 || elapsed >= total) return 99;
+
+	return (elapsed * 100) / total;
+}
+
+// Size taken in EEPROM by the calibration of this object.
+// Header (magic, version, size on 16 bits, channels), settings, channels, then a CRC.
+uint16_t CapADC::getCalibrationSize() const{
+	return 5 + sizeof(CapADCSetGlobal_t) + sizeof(CapADCSetLocal_t)
+			+ getStoredCount() * sizeof(CapADCStoredChannel_t) + 2;
+}
+
+// Save global settings, local settings and channels calibration to EEPROM, from address.
+// Only changed bytes are written. Returns the number of bytes used, so the next object can follow.
+uint16_t CapADC::saveCalibration(uint16_t address){
+	uint8_t count = getStoredCount();
+	uint16_t size = getCalibrationSize();
+	uint16_t crc = 0xffff;
+
+	uint8_t header[5] = {0xCA, CAP_ADC_STORE_VERSION, (uint8_t)(size & 0xff), (uint8_t)(size >> 8), count};
+	for(uint8_t i = 0; i < 5; ++i){
+		CAP_ADC_EEPROM_WRITE(address, header[i]);
+		crc = crcUpdate(crc, header[i]);
+		++address;
+	}
+
+	const uint8_t *data = (const uint8_t*)&_gSettings;
+	for(uint8_t i = 0; i < sizeof(CapADCSetGlobal_t); ++i){
+		CAP_ADC_EEPROM_WRITE(address, data[i]);
+		crc = crcUpdate(crc, data[i]);
+		++address;
+	}
+
+	CapADCSetLocal_t local = getLocalSettings();
+	data = (const uint8_t*)&local;
+	for(uint8_t i = 0; i < sizeof(CapADCSetLocal_t); ++i){
+		CAP_ADC_EEPROM_WRITE(address, data[i]);
+		crc = crcUpdate(crc, data[i]);
+		++address;
+	}
+
+	for(uint8_t c = 0; c < count; ++c){
+		CapADCStoredChannel_t stored;
+		saveChannel(c, stored);
+		data = (const uint8_t*)&stored;
+		for(uint8_t i = 0; i < sizeof(CapADCStoredChannel_t); ++i){
+			CAP_ADC_EEPROM_WRITE(address, data[i]);
+			crc = crcUpdate(crc, data[i]);
+			++address;
+		}
+	}
+
+	CAP_ADC_EEPROM_WRITE(address, crc & 0xff);
+	CAP_ADC_EEPROM_WRITE(address + 1, crc >> 8);
+
+	return size;
+}
+
+// Restore a calibration saved from address.
+// Fails if the record is missing, of another version or size, corrupted,
+// or if a channel now reads more than maxDrift away from its stored baseline.
+// Nothing is applied unless every check passes.
+bool CapADC::restoreCalibration(uint16_t address, uint16_t maxDrift){
+	uint8_t count = getStoredCount();
+	uint16_t size = getCalibrationSize();
+
+	if(CAP_ADC_EEPROM_READ(address) != 0xCA) return false;
+	if(CAP_ADC_EEPROM_READ(address + 1) != CAP_ADC_STORE_VERSION) return false;
+	if(CAP_ADC_EEPROM_READ(address + 2) != (size & 0xff)) return false;
+	if(CAP_ADC_EEPROM_READ(address + 3) != (size >> 8)) return false;
+	if(CAP_ADC_EEPROM_READ(address + 4) != count) return false;
+
+	// Check the whole record before applying any of it.
+	uint16_t crc = 0xffff;
+	for(uint16_t i = 0; i < size - 2; ++i){
+		crc = crcUpdate(crc, CAP_ADC_EEPROM_READ(address + i));
+	}
+
+	uint16_t stored = CAP_ADC_EEPROM_READ(address + size - 2);
+	stored |= (uint16_t)CAP_ADC_EEPROM_READ(address + size - 1) << 8;
+	if(crc != stored) return false;
+
+	address += 5;
+
+	CapADCSetGlobal_t global;
+	address = readStored(address, &global, sizeof(CapADCSetGlobal_t));
+	CapADCSetLocal_t local;
+	address = readStored(address, &local, sizeof(CapADCSetLocal_t));
+
+	// Global settings apply to the readings taken to check drift.
+	// They are shared by all objects: put the previous ones back if a check fails.
+	CapADCSetGlobal_t previous = _gSettings;
+	applyGlobalSettings(global);
+
+	CapADCStoredChannel_t channel;
+	uint16_t channels = address;
+	for(uint8_t c = 0; c < count; ++c){
+		address = readStored(address, &channel, sizeof(CapADCStoredChannel_t));
+		if(!checkChannel(c, channel, maxDrift)){
+			applyGlobalSettings(previous);
+			return false;
+		}
+	}
+
+	applyLocalSettings(local);
+
+	address = channels;
+	for(uint8_t c = 0; c < count; ++c){
+		address = readStored(address, &channel, sizeof(CapADCStoredChannel_t));
+		restoreChannel(c, channel);
+	}
+
+	return true;
+}
+
+// Statistics gathered since start or last reset, all zero unless CAP_ADC_STATS is set.
+const CapADCStats_t& CapADC::getStats() const{
+#if CAP_ADC_STATS
+	return _stats;
+#else
+	static const CapADCStats_t none;
+	return none;
+#endif
+}
+
+void CapADC::resetStats(){
+#if CAP_ADC_STATS
+	_stats = CapADCStats_t();
+#endif
+}
+
+// Record a telemetry frame on each update, with this id. Sliders and wheels use one id per segment,
+// from id on, the last one being the whole slider, matrices one per key, row after row.
+// Ids run up to 254: the streams that would go past are not recorded.
+// Only effective if CAP_ADC_TELEMETRY is set.
+void CapADC::setTelemetryId(uint8_t id){
+#if CAP_ADC_TELEMETRY
+	_telemetryId = id;
+#else
+	(void)id;
+#endif
+}
+
+// Set functions called when the object is touched, released, touched for a while, or slid along.
+// update() queues events, and dispatchEvents() calls these from the loop, once per event.
+// Events of an object without the matching function are not queued.
+void CapADC::onTouch(void (*callback)(CapADC*)){
+	_onTouch = callback;
+}
+
+void CapADC::onRelease(void (*callback)(CapADC*)){
+	_onRelease = callback;
+}
+
+// The long press is sent once per touch, when it has lasted delay ms.
+void CapADC::onLongPress(void (*callback)(CapADC*), uint16_t delay){
+	_onLongPress = callback;
+	_longPressDelay = delay;
+}
+
+// Sliders and wheels only. The delta is the move since the last event, a whole turn of a wheel being 256.
+void CapADC::onSlide(void (*callback)(CapADC*, int8_t)){
+	_onSlide = callback;
+}
+
+// Call the functions of all the events queued since last call, in order.
+// Returns the number of events dispatched.
+uint8_t CapADC::dispatchEvents(){
+	uint8_t count = 0;
+	CapADCEvent_t event;
+	while(_events.pop(event)){
+		CapADC *sensor = event.sensor;
+		switch(event.type){
+			case EventTouch:
+				if(sensor->_onTouch) sensor->_onTouch(sensor);
+				break;
+			case EventRelease:
+				if(sensor->_onRelease) sensor->_onRelease(sensor);
+				break;
+			case EventLongPress:
+				if(sensor->_onLongPress) sensor->_onLongPress(sensor);
+				break;
+			case EventSlide:
+				if(sensor->_onSlide) sensor->_onSlide(sensor, event.value);
+				break;
+		}
+		++count;
+	}
+
+	return count;
+}
+
+// Number of events lost because the queue was full: call dispatchEvents() more often.
+uint16_t CapADC::getLostEvents(){
+	return _lostEvents;
+}
+
+// Protected methods
+
+// Queue touch and release events on a debounced state change.
+void CapADC::eventTransition(uint8_t state, uint8_t previous){
+	if(state == Touch && previous != Touch){
+		_touching = true;
+		_touchStart = CAP_ADC_MILLIS();
+		if(_onTouch) pushEvent(EventTouch);
+	} else if(state != Touch && previous == Touch){
+		_touching = false;
+		if(_onRelease) pushEvent(EventRelease);
+	}
+}
+
+// Queue the long press event, once per touch.
+void CapADC::eventLongPress(){
+	if(!_touching || !_onLongPress) return;
+	if((CAP_ADC_MILLIS() - _touchStart) < _longPressDelay) return;
+
+	_touching = false;
+	pushEvent(EventLongPress);
+}
+
+void CapADC::eventSlide(int8_t delta){
+	if(_onSlide) pushEvent(EventSlide, delta);
+}
+
+void CapADC::pushEvent(uint8_t type, int8_t value){
+	CapADCEvent_t event = {this, type, value};
+	if(!_events.push(event) && _lostEvents != 0xffff) ++_lostEvents;
+}
+
+// Read size bytes from EEPROM at address. Returns the address following them.
+uint16_t CapADC::readStored(uint16_t address, void *data, uint8_t size){
+	uint8_t *bytes = (uint8_t*)data;
+	for(uint8_t i = 0; i < size; ++i){
+		bytes[i] = CAP_ADC_EEPROM_READ(address++);
+	}
+	return address;
+}
+
+// CRC-16/CCITT, the same as _crc_ccitt_update() from avr-libc, computed without table.
+uint16_t CapADC::crcUpdate(uint16_t crc, uint8_t data){
+	data ^= crc & 0xff;
+	data ^= data << 4;
+
+	return ((((uint16_t)data << 8) | (crc >> 8)) ^ (uint8_t)(data >> 4) ^ ((uint16_t)data << 3));
+}
+
+// Start an incremental tuning: baseline for a given time, then threshold, if any.
+void CapADC::startTune(uint32_t baselineLength, uint32_t thresholdLength){
+	_tuneStart = CAP_ADC_MILLIS();
+	_tuneBaselineLength = baselineLength;
+	_tuneThresholdLength = thresholdLength;
+	_tuneState = TuneBaseline;
+}
+
+// Time since the tuning started.
+uint32_t CapADC::tuneElapsed() const{
+	return CAP_ADC_MILLIS() - _tuneStart;
 }
@@ -21,37 +21,139 @@
 
 #include <Arduino.h>
 #include "CapacitiveADCChannel.h"
+#include "CapacitiveADCScanner.h"
+#include "CapacitiveADCFilter.h"
+#include "CapacitiveADCConfig.h"
+#include "CapacitiveADCStats.h"
+#include "CapacitiveADCTelemetry.h"
 
-struct CapADCSetGlobal_t{
+// EEPROM access used to store calibration.
+// They can be defined on the compiler command line to other functions,
+// e.g. a file backed stand-in when building the library off-target.
+#ifndef CAP_ADC_EEPROM_READ
+#include <EEPROM.h>
+#define CAP_ADC_EEPROM_READ(address)			EEPROM.read(address)
+#define CAP_ADC_EEPROM_WRITE(address, value)	EEPROM.update(address, value)
+#endif
+
+// Layout version of the stored calibration. Change it when the stored structs change.
+#define CAP_ADC_STORE_VERSION	3
+// Default maximal difference between a stored baseline and a new reading to accept a record.
+#define CAP_ADC_MAX_DRIFT		32
+
+// Number of events update() can queue before dispatchEvents() is called. A power of two, up to 128.
+#ifndef CAP_ADC_EVENT_QUEUE_SIZE
+#define CAP_ADC_EVENT_QUEUE_SIZE	16
+#endif
+
+// Stored structs are packed: their bytes are the same on the target and on hosts, without padding.
+struct __attribute__((packed)) CapADCSetGlobal_t{
 	uint8_t samples; 					// The number of samples taken for one read
 	uint8_t divider;					// The number that computes the average from reads
-	uint8_t expWeight;					// Weight for exp filter. ratio, 0 to 255. fixpoint math
 	uint8_t debounce;					// Delay to wait before a touch is effectively accounted
 	uint8_t noiseIncrement;				// Increment for noise detection
 	uint16_t noiseCountRising;			// Number of reads above noiseDelta for baseline adjust
 	uint16_t noiseCountFalling;			// Number of reads under noiseDelta for baseline adjust
 
-	CapADCSetGlobal_t():	samples(4),
-						divider(1),
-						expWeight(40),
-						debounce(2),
-						noiseIncrement(1),
-						noiseCountRising(50),
-						noiseCountFalling(5){}
+	constexpr CapADCSetGlobal_t():	samples(CapADCConfigGlobal::samples),
+						divider(CapADCConfigGlobal::divider),
+						debounce(CapADCConfigGlobal::debounce),
+						noiseIncrement(CapADCConfigGlobal::noiseIncrement),
+						noiseCountRising(CapADCConfigGlobal::noiseCountRising),
+						noiseCountFalling(CapADCConfigGlobal::noiseCountFalling){}
 };
 
-struct CapADCSetLocal_t{
+struct __attribute__((packed)) CapADCSetLocal_t{
 	// Threshold values
 	int16_t touchThreshold;
 	int16_t releaseThreshold;
 	uint8_t resetCounter;
+	// Proximity thresholds, pins only. Proximity is not detected when proxThreshold is 0.
+	int16_t proxThreshold;
+	int16_t proxReleaseThreshold;
+
+	constexpr CapADCSetLocal_t():	touchThreshold(CapADCConfigLocal::touchThreshold),
+						releaseThreshold(CapADCConfigLocal::releaseThreshold),
+						resetCounter(CapADCConfigLocal::resetCounter),
+						proxThreshold(CapADCConfigLocal::proxThreshold),
+						proxReleaseThreshold(CapADCConfigLocal::proxReleaseThreshold){}
+
+	constexpr CapADCSetLocal_t(int16_t touch, int16_t release, uint8_t reset,
+						int16_t prox = 0, int16_t proxRelease = 0):
+						touchThreshold(touch),
+						releaseThreshold(release),
+						resetCounter(reset),
+						proxThreshold(prox),
+						proxReleaseThreshold(proxRelease){}
+};
+
+// Local settings from a generated config struct, e.g. capADCLocalSettings<CapADCConfigChannel1>().
+template<typename Config>
+constexpr CapADCSetLocal_t capADCLocalSettings(){
+	return CapADCSetLocal_t(Config::touchThreshold, Config::releaseThreshold, Config::resetCounter,
+							Config::proxThreshold, Config::proxReleaseThreshold);
+}
+
+// Calibration of one channel, as stored in EEPROM.
+struct __attribute__((packed)) CapADCStoredChannel_t{
+	uint16_t baseline;
+	uint8_t chargeDelay;
+	uint8_t prescaler;
+	uint8_t resolution;
+};
+
+// Thresholds of a sensor, as used by update().
+// When CapADCConfigGlobal::fixed is true, they are the CapADCConfigLocal constants for every sensor:
+// update() uses them as immediates, no RAM holds them, and setting them changes nothing.
+template<bool Fixed>
+class CapADCThresholds{
+protected:
+	int16_t localTouchThreshold() const{return _touchThreshold;}
+	int16_t localReleaseThreshold() const{return _releaseThreshold;}
+	int16_t localProxThreshold() const{return _proxThreshold;}
+	int16_t localProxReleaseThreshold() const{return _proxReleaseThreshold;}
+
+	CapADCThresholds():	_touchThreshold(CapADCConfigLocal::touchThreshold),
+						_releaseThreshold(CapADCConfigLocal::releaseThreshold),
+						_proxThreshold(CapADCConfigLocal::proxThreshold),
+						_proxReleaseThreshold(CapADCConfigLocal::proxReleaseThreshold){}
 
-	CapADCSetLocal_t():	touchThreshold(50),
-						releaseThreshold(40),
-						resetCounter(255){}
+	void storeTouchThreshold(int16_t value){_touchThreshold = value;}
+	void storeReleaseThreshold(int16_t value){_releaseThreshold = value;}
+	void storeProxThreshold(int16_t value){_proxThreshold = value;}
+	void storeProxReleaseThreshold(int16_t value){_proxReleaseThreshold = value;}
+
+private:
+	int16_t _touchThreshold;
+	int16_t _releaseThreshold;
+	int16_t _proxThreshold;
+	int16_t _proxReleaseThreshold;
+};
+
+template<>
+class CapADCThresholds<true>{
+protected:
+	int16_t localTouchThreshold() const{return CapADCConfigLocal::touchThreshold;}
+	int16_t localReleaseThreshold() const{return CapADCConfigLocal::releaseThreshold;}
+	int16_t localProxThreshold() const{return CapADCConfigLocal::proxThreshold;}
+	int16_t localProxReleaseThreshold() const{return CapADCConfigLocal::proxReleaseThreshold;}
+
+	void storeTouchThreshold(int16_t){}
+	void storeReleaseThreshold(int16_t){}
+	void storeProxThreshold(int16_t){}
+	void storeProxReleaseThreshold(int16_t){}
+};
+
+class CapADC;
+
+// An event queued by update(), for dispatchEvents().
+struct CapADCEvent_t{
+	CapADC *sensor;
+	uint8_t type;
+	int8_t value;
 };
 
-class CapADC{
+class CapADC: public CapADCThresholds<CapADCConfigGlobal::fixed>{
 public:
 
 	enum state_t{
@@ -63,10 +165,22 @@ public:
 		Touch,					// 5
 	};
 
+	enum event_t{
+		EventTouch = 0,
+		EventRelease,			// 1
+		EventLongPress,			// 2
+		EventSlide,				// 3
+	};
+
+	CapADC();
+
 	virtual void setChargeDelay(uint8_t value) = 0;
+	virtual void setResolution(uint8_t bits) = 0;
 
 	virtual void setTouchThreshold(uint16_t threshold);
 	virtual void setReleaseThreshold(uint16_t threshold);
+	void setProxThreshold(uint16_t threshold);
+	void setProxReleaseThreshold(uint16_t threshold);
 
 	void applyGlobalSettings(const CapADCSetGlobal_t& settings);
 	CapADCSetGlobal_t* globalSettings();
@@ -74,16 +188,150 @@ public:
 
 
 	void applyLocalSettings(const CapADCSetLocal_t& settings);
-	CapADCSetLocal_t* localSettings();
 	CapADCSetLocal_t getLocalSettings()const;
 
+	bool isTuning() const;
+	uint8_t getTuneProgress() const;
+
+	uint16_t getCalibrationSize() const;
+	uint16_t saveCalibration(uint16_t address);
+	bool restoreCalibration(uint16_t address, uint16_t maxDrift = CAP_ADC_MAX_DRIFT);
+
+	const CapADCStats_t& getStats() const;
+	void resetStats();
+
+	void setTelemetryId(uint8_t id);
+
+	void onTouch(void (*callback)(CapADC*));
+	void onRelease(void (*callback)(CapADC*));
+	void onLongPress(void (*callback)(CapADC*), uint16_t delay = 1000);
+	void onSlide(void (*callback)(CapADC*, int8_t));
+
+	static uint8_t dispatchEvents();
+	static uint16_t getLostEvents();
+
 protected:
+	// Phases of an incremental tuning, run by update()
+	enum tune_t{
+		TuneIdle = 0,
+		TuneBaseline,			// 1
+		TuneThreshold,			// 2
+	};
+
+	void startTune(uint32_t baselineLength, uint32_t thresholdLength);
+	uint32_t tuneElapsed() const;
+
+	// Hooks for storing calibration, one call per channel.
+	// checkChannel() must leave the object as it was, restoreChannel() applies.
+	virtual uint8_t getStoredCount() const{return 0;}
+	virtual void saveChannel(uint8_t index, CapADCStoredChannel_t& stored){}
+	virtual bool checkChannel(uint8_t index, const CapADCStoredChannel_t& stored, uint16_t maxDrift){return false;}
+	virtual void restoreChannel(uint8_t index, const CapADCStoredChannel_t& stored){}
+
+	static uint16_t crcUpdate(uint16_t crc, uint8_t data);
+	static uint16_t readStored(uint16_t address, void *data, uint8_t size);
+
+	// Global settings used by update(). Constants when CapADCConfigGlobal::fixed, so they fold.
+	static uint8_t globalSamples(){
+		if(CapADCConfigGlobal::fixed) return CapADCConfigGlobal::samples;
+		return _gSettings.samples;
+	}
+
+	static uint8_t globalDivider(){
+		if(CapADCConfigGlobal::fixed) return CapADCConfigGlobal::divider;
+		return _gSettings.divider;
+	}
+
+	static uint8_t globalDebounce(){
+		if(CapADCConfigGlobal::fixed) return CapADCConfigGlobal::debounce;
+		return _gSettings.debounce;
+	}
+
+	static uint8_t globalNoiseIncrement(){
+		if(CapADCConfigGlobal::fixed) return CapADCConfigGlobal::noiseIncrement;
+		return _gSettings.noiseIncrement;
+	}
+
+	static uint16_t globalNoiseCountRising(){
+		if(CapADCConfigGlobal::fixed) return CapADCConfigGlobal::noiseCountRising;
+		return _gSettings.noiseCountRising;
+	}
+
+	static uint16_t globalNoiseCountFalling(){
+		if(CapADCConfigGlobal::fixed) return CapADCConfigGlobal::noiseCountFalling;
+		return _gSettings.noiseCountFalling;
+	}
+
+	// Statistics hooks. They are empty unless CAP_ADC_STATS is set.
+#if CAP_ADC_STATS
+	static uint32_t statsStart(){return CAP_ADC_CYCLES();}
+	void statsRead(uint32_t start, uint16_t conversions){
+		_stats.conversions += conversions;
+		_stats.read.add(CAP_ADC_CYCLES() - start);
+	}
+	void statsUpdate(uint32_t start){_stats.update.add(CAP_ADC_CYCLES() - start);}
+	void statsBaseline(){++_stats.baselineAdjust;}
+	void statsDebounce(){++_stats.debounceReject;}
+	void statsTransition(){++_stats.transitions;}
+#else
+	static uint32_t statsStart(){return 0;}
+	void statsRead(uint32_t, uint16_t){}
+	void statsUpdate(uint32_t){}
+	void statsBaseline(){}
+	void statsDebounce(){}
+	void statsTransition(){}
+#endif
+
+	void eventTransition(uint8_t state, uint8_t previous);
+	void eventLongPress();
+	void eventSlide(int8_t delta);
+	void pushEvent(uint8_t type, int8_t value = 0);
+
+	// Telemetry hook. It is empty unless CAP_ADC_TELEMETRY is set.
+#if CAP_ADC_TELEMETRY
+	void telemetry(uint8_t index, uint8_t state, uint16_t raw, uint16_t filtered, uint16_t baseline, int16_t delta){
+		// Ids past 254 would wrap onto other streams: they are not recorded.
+		uint16_t id = _telemetryId + index;
+		if(id >= CapADCTelemetry::NoId) return;
+		CapADCTelemetry::record(id, state, raw, filtered, baseline, delta);
+	}
+#else
+	void telemetry(uint8_t, uint8_t, uint16_t, uint16_t, uint16_t, int16_t){}
+#endif
 
 	// Global settings
 	static CapADCSetGlobal_t _gSettings;
 
-	// Local (pin) settings
-	CapADCSetLocal_t _lSettings;
+	// Local (pin) settings, the thresholds being held by CapADCThresholds.
+	uint8_t _resetCounter;
+
+	// Tuning state
+	uint8_t _tuneState;
+	uint32_t _tuneStart;
+	uint32_t _tuneBaselineLength;
+	uint32_t _tuneThresholdLength;
+
+#if CAP_ADC_STATS
+	CapADCStats_t _stats;
+#endif
+
+	// Events callbacks, and long press tracking
+	void (*_onTouch)(CapADC*);
+	void (*_onRelease)(CapADC*);
+	void (*_onLongPress)(CapADC*);
+	void (*_onSlide)(CapADC*, int8_t);
+	uint16_t _longPressDelay;
+	uint32_t _touchStart;
+	bool _touching;
+
+	// Events waiting to be dispatched, for all objects
+	static CapADCRing<CapADCEvent_t, CAP_ADC_EVENT_QUEUE_SIZE> _events;
+	static uint16_t _lostEvents;
+
+#if CAP_ADC_TELEMETRY
+	// Id of the first frame stream of this object, NoId when not recorded
+	uint8_t _telemetryId;
+#endif
 
 };
 
@@ -17,6 +17,7 @@
  */
 
 #include "CapacitiveADCChannel.h"
+#include <avr/sleep.h>
 
 #if defined(CORE_TEENSY)
 static const uint8_t PROGMEM adc_mapping[] = {
@@ -26,6 +27,70 @@ static const uint8_t PROGMEM adc_mapping[] = {
 
 #endif
 
+#if CAP_ADC_DELAY_TIMER == 2
+// Timer 2 in CTC mode, F_CPU / 32.
+#define CAP_ADC_TIMER_VECT				TIMER2_COMPA_vect
+#define CAP_ADC_TIMER_DIVIDER			32
+#define CAP_ADC_TIMER_MAX				0xFF
+#define CAP_ADC_TCCRA					TCCR2A
+#define CAP_ADC_TCCRB					TCCR2B
+#define CAP_ADC_TCNT					TCNT2
+#define CAP_ADC_OCR						OCR2A
+#define CAP_ADC_TIMSK					TIMSK2
+#define CAP_ADC_TIFR					TIFR2
+#define CAP_ADC_OCIE					OCIE2A
+#define CAP_ADC_OCF						OCF2A
+#define CAP_ADC_TCCRA_CTC				_BV(WGM21)
+#define CAP_ADC_TCCRB_CTC				(_BV(CS21) | _BV(CS20))
+#elif CAP_ADC_DELAY_TIMER == 3
+// Timer 3 in CTC mode, F_CPU / 8.
+#define CAP_ADC_TIMER_VECT				TIMER3_COMPA_vect
+#define CAP_ADC_TIMER_DIVIDER			8
+#define CAP_ADC_TIMER_MAX				0xFFFF
+#define CAP_ADC_TCCRA					TCCR3A
+#define CAP_ADC_TCCRB					TCCR3B
+#define CAP_ADC_TCNT					TCNT3
+#define CAP_ADC_OCR						OCR3A
+#define CAP_ADC_TIMSK					TIMSK3
+#define CAP_ADC_TIFR					TIFR3
+#define CAP_ADC_OCIE					OCIE3A
+#define CAP_ADC_OCF						OCF3A
+#define CAP_ADC_TCCRA_CTC				0
+#define CAP_ADC_TCCRB_CTC				(_BV(WGM32) | _BV(CS31))
+#endif
+
+// The channel currently owning the ADC.
+CapADCChannel * volatile CapADCChannel::_active = 0;
+void (*CapADCChannel::_callback)(CapADCChannel*) = 0;
+bool CapADCChannel::_delayTimer = false;
+bool CapADCChannel::_sleepConversions = false;
+void (* volatile CapADCChannel::_wake)(void) = 0;
+
+#if CAP_ADC_DELAY_TIMER
+// Timer settings, saved while the delay timer is used.
+static uint8_t timerTCCRA;
+static uint8_t timerTCCRB;
+static uint16_t timerOCR;
+static uint8_t timerTIMSK;
+#endif
+
+#if CAP_ADC_ISR
+// ADC conversion complete interrupt.
+// Weak, so that another definition takes over instead of failing to link.
+ISR(ADC_vect, __attribute__((weak))){
+	CapADCChannel::handleInterrupt();
+}
+
+#if CAP_ADC_DELAY_TIMER
+// Delay timer compare match: a charge transfer is done.
+// Not weak: tone() defines the same vector, and silently taking it over would leave reads
+// waiting for a timer interrupt that never comes. Linking both fails instead, see CAP_ADC_DELAY_TIMER.
+ISR(CAP_ADC_TIMER_VECT){
+	CapADCChannel::handleTimer();
+}
+#endif
+#endif
+
 // Public methods
 
 // Constructor
@@ -47,6 +112,15 @@ CapADCChannel::CapADCChannel(){
 	// Default transfer delay
 	_transfertDelay = 4;
 
+	_phase = Idle;
+	_value = 0;
+	_resolution = 10;
+	_prescaler = 0;
+	_sleepRead = false;
+
+	_portRDrivePin = 0;
+	_maskDrivePin = 0;
+
 	// The first reading is longer than a normal one, so let's do one.
 	while(ADCSRA & _BV(ADSC));
 
@@ -133,6 +207,40 @@ void CapADCChannel::init(uint8_t pin, uint8_t friendPin){
 	*_portRFriendPin &= ~_maskFriendPin;
 
 	// Set the ADC registers here, because analogRead initialise after third party libraries.
+	initADC();
+}
+
+// Set a drive pin, to measure the mutual capacitance between it and the electrode, instead of
+// the electrode own capacitance. Any digital pin can drive, NoDrive goes back to self capacitance.
+// The electrode is then held at the s&h capacitor level, and the drive pin edge brings the charge:
+// a rising edge for the first conversion, a falling one for the second.
+// The value is twice the charge the drive pin couples to the electrode, from 0 to twice the
+// full scale. A touch lowers the coupling, so the value drops.
+void CapADCChannel::setDrivePin(uint8_t pin){
+	if(pin == NoDrive){
+		_maskDrivePin = 0;
+		return;
+	}
+
+	uint8_t reg = digitalPinToPort(pin);
+	_maskDrivePin = digitalPinToBitMask(pin);
+	_portRDrivePin = (uint8_t*)portOutputRegister(reg);
+
+	// Turn pin OUTPUT, LOW.
+	*(uint8_t*)portModeRegister(reg) |= _maskDrivePin;
+	*_portRDrivePin &= ~_maskDrivePin;
+}
+
+// Same, with the drive pin port output register and mask, already set OUTPUT, LOW by the caller.
+// Skips the pin lookups, for callers switching drive pins on every read, like the matrix.
+void CapADCChannel::setDrivePin(uint8_t *port, uint8_t mask){
+	_portRDrivePin = port;
+	_maskDrivePin = mask;
+}
+
+// Set the ADC registers for capacitive reads.
+// Shared by all channels, runtime or compile-time configured.
+void CapADCChannel::initADC(){
 #if defined(MUX5)
 	ADMUX = 0b01011111;
 	ADCSRA = 0b10000011;
@@ -155,10 +263,6 @@ void CapADCChannel::init(uint8_t pin, uint8_t friendPin){
 	ADCSRB = 0b00000000;
 
 #endif
-
-	// Left justified result (we only read the 8 upper bits)
-//	ADMUX |= _BV(5);
-
 }
 
 // Set the charge delay.
@@ -168,98 +272,297 @@ void CapADCChannel::setChargeDelay(uint8_t value){
 	_transfertDelay = value;
 }
 
+uint8_t CapADCChannel::getChargeDelay() const{
+	return _transfertDelay;
+}
+
+
+// Set the resolution of reads, 8 or 10 bits.
+// 8 bits reads only get the high byte of a left-adjusted result, with a faster ADC clock,
+// so they are about twice as fast. Deltas are then about four times smaller:
+// set thresholds accordingly, or let tuneThreshold() compute them.
+void CapADCChannel::setResolution(uint8_t bits){
+	_resolution = (bits == 8)?8:10;
+}
+
+uint8_t CapADCChannel::getResolution() const{
+	return _resolution;
+}
+
+// Set the ADC prescaler used for this channel, as the ADPS bits of ADCSRA:
+// 1 is F_CPU / 2, up to 7 for F_CPU / 128.
+// 0 uses the default for the resolution: 4 for 8 bits, 8 for 10 bits.
+// A faster clock gives faster reads, but more noise.
+void CapADCChannel::setPrescaler(uint8_t value){
+	_prescaler = value & 0b111;
+}
+
+uint8_t CapADCChannel::getPrescaler() const{
+	return _prescaler;
+}
+
+// Find the fastest prescaler that still gives a clean enough signal.
+// For each prescaler, from the default one of the resolution, or slower if CAP_ADC_MAX_CLOCK
+// asks so, reads are taken without touching the electrode.
+// The signal is their average, the noise their peak to peak amplitude, at least 1:
+// with 8 bits reads, it is often 0, which would let any prescaler pass.
+// The first prescaler for which signal >= minRatio * noise is kept and returned.
+// If none is good enough, the slowest one is kept.
+// Returns 0 and changes nothing while a scanner chains reads: stop it first.
+uint8_t CapADCChannel::calibratePrescaler(uint8_t minRatio, uint8_t reads){
+	if(_callback) return 0;
+	if(reads == 0) reads = 1;
+
+	uint8_t prescaler = (_resolution == 8)?0b010:0b011;
+	while(prescaler < 7 && (F_CPU >> prescaler) > CAP_ADC_MAX_CLOCK) ++prescaler;
+
+	for(; prescaler < 7; ++prescaler){
+		setPrescaler(prescaler);
+
+		// One discarded read, as the ADC clock just changed.
+		read();
+
+		int32_t sum = 0;
+		int16_t min = 0x7FFF;
+		int16_t max = -0x7FFF;
+		for(uint8_t i = 0; i < reads; ++i){
+			int16_t value = read();
+			sum += value;
+			if(value < min) min = value;
+			if(value > max) max = value;
+		}
+
+		int32_t signal = sum / reads;
+		if(signal < 0) signal = -signal;
+		uint16_t noise = max - min;
+		if(noise == 0) noise = 1;
+
+		if(signal >= (int32_t)minRatio * noise) break;
+	}
+
+	setPrescaler(prescaler);
+	return prescaler;
+}
+
+// Set blocking reads to wait in ADC noise reduction sleep mode.
+// The CPU and I/O clocks are stopped while converting, so each sample is cleaner
+// and fewer samples are needed for the same stability.
+// As timer 0 is stopped too, millis() is a bit late after each read.
+void CapADCChannel::setSleepRead(bool value){
+	_sleepRead = value;
+}
 
 // Read function.
+// Blocking wrapper around the interrupt-driven sequence: start it, then wait for its result.
+// With interrupts disabled, the sequence is stepped by polling the ADC flag instead.
+// Returns 0 while a scanner chains reads: the ADC is then the scanner's only.
 int16_t CapADCChannel::read(){
-//	ADMUX |= _BV(5);
-	ADCSRA &= ~0b111;
-	ADCSRA |= 0b011;
-	ADCSRB |= _BV(7);
+	if(_callback) return 0;
+
+	bool polled = !(SREG & _BV(SREG_I));
+	// Not with the delay timer, whose clock is stopped in the ADC noise reduction sleep mode.
+	bool sleeping = _sleepRead && !_delayTimer && !polled;
+
+	// Wait for another channel to release the ADC.
+	while(!startSequence(sleeping)){
+		if(polled) service();
+		CAP_ADC_WAIT();
+	}
+
+	if(polled){
+		while(!available()){
+			service();
+			CAP_ADC_WAIT();
+		}
+	} else if(sleeping){
+		// The sequence doesn't start its conversions: entering the sleep mode does,
+		// so the whole sample and conversion happen with the CPU and I/O clocks stopped.
+		// The ADC interrupt wakes us up, and the sequence goes on until the next conversion.
+		// Interrupts are enabled right before sleeping, so a conversion ending
+		// between the test and the sleep instruction still wakes the CPU.
+		uint8_t oldSREG = SREG;
+		set_sleep_mode(SLEEP_MODE_ADC);
+		for(;;){
+			cli();
+			if(available()) break;
+			sleep_enable();
+			sei();
+			sleep_cpu();
+			sleep_disable();
+		}
+		SREG = oldSREG;
+	} else {
+		while(!available()) CAP_ADC_WAIT();
+	}
+
+	return getValue();
+}
+
+// Start a non-blocking read sequence.
+// The electrode is charged here, then the first conversion launched,
+// the ADC interrupt then sequences the discharge and second conversion.
+// With the delay timer, the charge goes on from the timer interrupt instead.
+// Returns false if the ADC is already used by a channel.
+bool CapADCChannel::start(){
+	return startSequence(false);
+}
+
+// Start a read sequence, whose conversions are launched by the sequence itself,
+// or, with sleepConversions, left to the sleep instruction of a blocking read().
+bool CapADCChannel::startSequence(bool sleepConversions){
+	uint8_t oldSREG = SREG;
+	cli();
+	if(_active){
+		SREG = oldSREG;
+		return false;
+	}
+	_active = this;
+	_sleepConversions = sleepConversions;
+	// The delay timer now times this sequence: a pending wakeAfter() is dropped.
+	_wake = 0;
+	SREG = oldSREG;
+
+	setADCMode(_resolution, _prescaler);
 
-	int16_t value = 0;
-//	uint32_t length = micros();
 	// Charge the pin
 	// Discharge the ADC s&h cap by linking it to ground.
 	// Turn friend pin OUTPUT, LOW
 	*_portRFriendPin &= ~_maskFriendPin;
 	setMux(_friendChannel);
-	// Turn friend pin OUTPUT, LOW
-//	*_ddrRFriendPin |= _maskFriendPin;
 
-	// Charge the electrode.
+	// Charge the electrode, or for mutual capacitance, keep it discharged as the s&h cap.
 	// Turn pin OUTPUT, HIGH.
-//	*_ddrRPin |= _maskPin;
-	*_portRPin |= _maskPin;
+	if(!_maskDrivePin) *_portRPin |= _maskPin;
 	// Wait for the electrode to be charged.
-	delayMicroseconds(_transfertDelay);
-
-	// Set the pin to input, three-stated.
-	*_ddrRPin &= ~_maskPin;
-	*_portRPin &= ~_maskPin;
-	// Set the ADC channel to that pin.
-	setMux(_channel);
-	// Launch a conversion, and wait for it to be done.
-	ADCSRA |= _BV(ADSC);
+	wait(Charge);
 
-	// Wait at least one ADC clock cycle before to change ADMUX.
-/*	asm volatile(
-		"NOP"	"\n\t"
-		"NOP"	"\n\t"
-		"NOP"	"\n\t"
-		"NOP"	"\n\t"
-		);
-*/
+	return true;
+}
 
-	// Set the next (we can change it before conversion it's done as ADMUX is buffered)
+// Tells if the read sequence started by start() is done.
+bool CapADCChannel::available() const{
+	return _phase == Done;
+}
 
-	while(ADCSRA & _BV(ADSC));
+// Get the value of the last read sequence, and release it.
+int16_t CapADCChannel::getValue(){
+	_phase = Idle;
+	return _value;
+}
 
-	// Get value from reading.
-//	value = ADCH;
-	value = ADCL;
-	value += ((uint16_t)ADCH << 8);
+// Tells if any channel is currently using the ADC.
+bool CapADCChannel::isBusy(){
+	return _active != 0;
+}
 
-//	Serial.println(value);
+// Called from the ADC interrupt: forward the end of conversion to the channel owning the ADC.
+// Once a sequence is done, the callback (if any) can chain the next one.
+void CapADCChannel::handleInterrupt(){
+	CapADCChannel *channel = _active;
+	if(!channel) return;
 
-	setMux(_friendChannel);
+	channel->nextPhase();
+	if(channel->_phase == Done && _callback) _callback(channel);
+}
 
-	// Turn friend pin OUTPUT, HIGH
-//	*_ddrRFriendPin |= _maskFriendPin;
-	*_portRFriendPin |= _maskFriendPin;
-	// Discharge the electrode.
-	// Turn pin OUTPUT, LOW.
-	*_ddrRPin |= _maskPin;
-	*_portRPin &= ~_maskPin;
-	// Wait for the electrode to be discharged.
-	delayMicroseconds(_transfertDelay);
+// Called from the delay timer interrupt: the charge transfer of the channel owning the ADC is done,
+// or, when none does, the wait asked with wakeAfter() is.
+void CapADCChannel::handleTimer(){
+#if CAP_ADC_DELAY_TIMER
+	CAP_ADC_TIMSK &= ~_BV(CAP_ADC_OCIE);
+#endif
+	CapADCChannel *channel = _active;
+	if(channel){
+		channel->nextPhase();
+		return;
+	}
 
-//	value -= share();
-	// Turn pin INPUT, three-stated
-	*_ddrRPin &= ~_maskPin;
-	*_portRPin &= ~_maskPin;
-	// Set the ADC channel to that pin.
-	setMux(_channel);
-	// Launch a conversion, and wait for it to be done.
-	ADCSRA |= _BV(ADSC);
+	void (*wake)(void) = _wake;
+	_wake = 0;
+	if(wake) wake();
+}
 
-	while(ADCSRA & _BV(ADSC));
+// Step the read sequence from the main code, when interrupts are disabled:
+// does what the ADC interrupt would do, if a conversion is done.
+// Interrupts are disabled meanwhile, so it can't run twice for the same event.
+void CapADCChannel::service(){
+	uint8_t oldSREG = SREG;
+	cli();
+#if CAP_ADC_DELAY_TIMER
+	if((CAP_ADC_TIMSK & _BV(CAP_ADC_OCIE)) && (CAP_ADC_TIFR & _BV(CAP_ADC_OCF))){
+		CAP_ADC_TIFR = _BV(CAP_ADC_OCF);
+		handleTimer();
+	}
+#endif
+	if((ADCSRA & _BV(ADIE)) && (ADCSRA & _BV(ADIF))){
+		// Writing ADIF clears it.
+		ADCSRA |= _BV(ADIF);
+		handleInterrupt();
+	}
+	SREG = oldSREG;
+}
 
-//	value -= ADCH;
-	uint16_t newValue = ADCL;
-	newValue += ((uint16_t)ADCH << 8);
-//	Serial.println(newValue);
-//	Serial.println();
+// Time the charge transfers with the delay timer interrupt, instead of busy loops.
+// Read sequences then never wait in an interrupt, which matters when they are chained
+// from it by the scanner. The timer settings are saved, and restored when set back to false.
+// Without a delay timer (CAP_ADC_DELAY_TIMER 0), this does nothing.
+// Only while no channel is busy.
+void CapADCChannel::setDelayTimer(bool value){
+#if CAP_ADC_DELAY_TIMER
+	if(value == _delayTimer) return;
+
+	uint8_t oldSREG = SREG;
+	cli();
+	if(value){
+		timerTCCRA = CAP_ADC_TCCRA;
+		timerTCCRB = CAP_ADC_TCCRB;
+		timerOCR = CAP_ADC_OCR;
+		timerTIMSK = CAP_ADC_TIMSK;
+
+		CAP_ADC_TIMSK = 0;
+		CAP_ADC_TCCRA = CAP_ADC_TCCRA_CTC;
+		CAP_ADC_TCCRB = CAP_ADC_TCCRB_CTC;
+	} else {
+		_wake = 0;
+		CAP_ADC_TIMSK = 0;
+		CAP_ADC_TCCRA = timerTCCRA;
+		CAP_ADC_TCCRB = timerTCCRB;
+		CAP_ADC_OCR = timerOCR;
+		CAP_ADC_TIFR = 0xFF;
+		CAP_ADC_TIMSK = timerTIMSK;
+	}
+	_delayTimer = value;
+	SREG = oldSREG;
+#endif
+}
 
-	value -= newValue;
-//	Serial.println(value);
+// Call a function from the delay timer interrupt, after at most us microseconds, while no channel
+// uses the ADC. A wait longer than the timer can count ends early: the function checks the time,
+// and waits again if needed. Used by the scanner to start its scans on time, whatever the loop does.
+// Returns false, and calls nothing, without delay timer in use or while a channel is busy.
+bool CapADCChannel::wakeAfter(uint32_t us, void (*callback)(void)){
+#if CAP_ADC_DELAY_TIMER
+	uint8_t oldSREG = SREG;
+	cli();
+	if(!_delayTimer || _active){
+		SREG = oldSREG;
+		return false;
+	}
 
+	_wake = callback;
+	armTimer(us);
+	SREG = oldSREG;
 
-	*_ddrRPin |= _maskPin;
-	*_portRPin &= ~_maskPin;
-	*_ddrRFriendPin |= _maskFriendPin;
-	*_portRFriendPin &= ~_maskFriendPin;
+	return true;
+#else
+	return false;
+#endif
+}
 
-	return value;
+// Set the function called from the interrupt when a read sequence is done.
+// Used by the scanner to pipeline conversions of several channels.
+void CapADCChannel::setCallback(void (*callback)(CapADCChannel*)){
+	_callback = callback;
 }
 
 // Private methods
@@ -290,14 +593,135 @@ uint8_t CapADCChannel::share(){
 	return value;
 }
 */
+// Start the delay timer for us microseconds, or the most it counts, and enable its interrupt.
+void CapADCChannel::armTimer(uint32_t us){
+#if CAP_ADC_DELAY_TIMER
+	// Rounded up, plus one count for the timer prescaler phase.
+	uint32_t compare = CAP_ADC_TIMER_MAX;
+	if(us < ((uint32_t)CAP_ADC_TIMER_MAX * CAP_ADC_TIMER_DIVIDER) / clockCyclesPerMicrosecond()){
+		compare = (us * clockCyclesPerMicrosecond() + CAP_ADC_TIMER_DIVIDER - 1) / CAP_ADC_TIMER_DIVIDER + 1;
+		if(compare > CAP_ADC_TIMER_MAX) compare = CAP_ADC_TIMER_MAX;
+	}
+
+	CAP_ADC_TCNT = 0;
+	CAP_ADC_OCR = compare;
+	CAP_ADC_TIFR = _BV(CAP_ADC_OCF);
+	CAP_ADC_TIMSK |= _BV(CAP_ADC_OCIE);
+#endif
+}
+
+// Wait for a charge transfer, then step the sequence.
+// With the delay timer, the wait is a timer compare, and the sequence goes on from its interrupt.
+void CapADCChannel::wait(uint8_t phase){
+	_phase = phase;
+
+#if CAP_ADC_DELAY_TIMER
+	if(_delayTimer){
+		armTimer(_transfertDelay);
+		return;
+	}
+#endif
+
+	CAP_ADC_DELAY_US(_transfertDelay);
+	nextPhase();
+}
+
+// Step the read sequence after each charge transfer and end of conversion.
+// Runs from the ADC interrupt, the delay timer interrupt, or start().
+void CapADCChannel::nextPhase(){
+	if(_phase == Charge){
+		// Set the pin to input, three-stated.
+		*_ddrRPin &= ~_maskPin;
+		*_portRPin &= ~_maskPin;
+		// Set the ADC channel to that pin.
+		setMux(_channel);
+		// Mutual capacitance: the drive rising edge brings charge to the electrode and s&h cap.
+		if(_maskDrivePin) *_portRDrivePin |= _maskDrivePin;
+		// Launch a conversion, with interrupt enabled. Writing ADIF clears a pending flag.
+		// When sleeping, the conversion starts with the sleep mode instead.
+		_phase = ChargeConversion;
+		ADCSRA |= _BV(ADIF) | _BV(ADIE) | (_sleepConversions?0:_BV(ADSC));
+
+	} else if(_phase == ChargeConversion){
+		// Get value from reading.
+		_value = getConversion(_resolution);
+
+		setMux(_friendChannel);
+
+		// Turn friend pin OUTPUT, HIGH
+		*_portRFriendPin |= _maskFriendPin;
+		// Discharge the electrode, or for mutual capacitance, charge it as the s&h cap.
+		// Turn pin OUTPUT, LOW.
+		*_ddrRPin |= _maskPin;
+		if(_maskDrivePin){
+			*_portRPin |= _maskPin;
+		} else {
+			*_portRPin &= ~_maskPin;
+		}
+		// Wait for the electrode to be discharged.
+		wait(Discharge);
+
+	} else if(_phase == Discharge){
+		// Turn pin INPUT, three-stated
+		*_ddrRPin &= ~_maskPin;
+		*_portRPin &= ~_maskPin;
+		// Set the ADC channel to that pin.
+		setMux(_channel);
+		// Mutual capacitance: the drive falling edge takes charge from the electrode and s&h cap.
+		if(_maskDrivePin) *_portRDrivePin &= ~_maskDrivePin;
+		// Launch the second conversion.
+		_phase = DischargeConversion;
+		if(!_sleepConversions) ADCSRA |= _BV(ADSC);
+
+	} else if(_phase == DischargeConversion){
+		_value -= getConversion(_resolution);
+		// Mutual capacitance: the first conversion is the charge brought by the drive edge,
+		// the second is the full scale less the charge taken. Add the full scale back,
+		// so the value is twice the coupled charge, from 0 up.
+		if(_maskDrivePin) _value += (_resolution == 8)?255:1023;
+
+		*_ddrRPin |= _maskPin;
+		*_portRPin &= ~_maskPin;
+		*_ddrRFriendPin |= _maskFriendPin;
+		*_portRFriendPin &= ~_maskFriendPin;
+
+		// Release the ADC.
+		ADCSRA &= ~_BV(ADIE);
+		_phase = Done;
+		_active = 0;
+	}
+}
+
+// Set ADC result adjustment and clock for a resolution.
+// 10 bits: right-adjusted, prescaler 8 by default. 8 bits: left-adjusted, prescaler 4 by default.
+void CapADCChannel::setADCMode(uint8_t bits, uint8_t prescaler){
+	if(bits == 8){
+		ADMUX |= _BV(ADLAR);
+		if(prescaler == 0) prescaler = 0b010;
+	} else {
+		ADMUX &= ~_BV(ADLAR);
+		if(prescaler == 0) prescaler = 0b011;
+	}
+	ADCSRA = (ADCSRA & ~0b111) | (prescaler & 0b111);
+	ADCSRB |= _BV(7);
+}
+
+// Get the result of the last conversion.
+// For 8 bits, the result is left-adjusted so ADCH is enough.
+uint16_t CapADCChannel::getConversion(uint8_t bits){
+	if(bits == 8) return ADCH;
+
+	uint16_t value = ADCL;
+	value += ((uint16_t)ADCH << 8);
+	return value;
+}
+
 // Set the ADC to a channel.
 // That can be ground for discharging, electrode pin for reading, or friend pin for charging.
 void CapADCChannel::setMux(uint8_t channel){
-	// Set channel number to 0
-	ADMUX &= ~(0x1F);
-
-	// Set channel to right channel number
-	ADMUX |= (channel & 0x07);
+	// Set channel to right channel number, in one write:
+	// clearing the channel first would connect the s&h cap to channel 0 meanwhile.
+	ADMUX = (ADMUX & ~(0x1F)) | (channel & 0x07);
 #if !defined(__AVR_ATTiny24__) && !defined(__AVR_ATTiny44__) && !defined(__AVR_ATTiny84__) &&\
 	!defined(__AVR_ATTiny24A__) && !defined(__AVR_ATTiny44A__) && !defined(__AVR_ATTiny84A__)
 #if defined(MUX5)
@@ -21,6 +21,66 @@
 
 #include <Arduino.h>
 
+// Time sources used by the library.
+// They can be defined on the compiler command line to other functions,
+// e.g. a virtual clock when building the library off-target against a simulated ADC.
+#ifndef CAP_ADC_MILLIS
+#define CAP_ADC_MILLIS()				millis()
+#endif
+
+#ifndef CAP_ADC_MICROS
+#define CAP_ADC_MICROS()				micros()
+#endif
+
+#ifndef CAP_ADC_DELAY_US
+#define CAP_ADC_DELAY_US(us)			delayMicroseconds(us)
+#endif
+
+// Body of the busy-wait loops, empty on the target.
+// The host simulator (extras/simulator) lets its virtual clock run there.
+#ifndef CAP_ADC_WAIT
+#define CAP_ADC_WAIT()
+#endif
+
+// Fastest ADC clock calibratePrescaler() may select, in Hz.
+// calibratePrescaler() starts from the default prescaler of the resolution, F_CPU / 4 for 8 bits
+// and F_CPU / 8 for 10 bits, the fastest clocks the library reads with: this only slows it more.
+// The default lets a 16MHz board use both defaults. Lower it for a full 10 bits accuracy.
+#ifndef CAP_ADC_MAX_CLOCK
+#define CAP_ADC_MAX_CLOCK				4000000UL
+#endif
+
+// The library defines ISR(ADC_vect), as a weak symbol.
+// A sketch or library needing the ADC interrupt for something else can define its own,
+// or set this to 0. That ISR must call CapADCChannel::handleInterrupt() while isBusy().
+#ifndef CAP_ADC_ISR
+#define CAP_ADC_ISR						1
+#endif
+
+// Timer used to wait for the charge transfers from interrupts, see setDelayTimer().
+// 2 for timer 2, 3 for timer 3, 0 for none: the waits are then busy loops.
+// The timer is taken from analogWrite() while in use.
+// The library defines the timer compare A interrupt, as does tone() for its own timer:
+// timer 2 on the 328P and 2560, timer 3 on the 32U4. A sketch using both fails to link,
+// with a multiple definition of that vector (__vector_7 on the 328P). Set this to another
+// timer, or to 0, for the whole build, to use tone().
+#ifndef CAP_ADC_DELAY_TIMER
+#if defined(TIMER2_COMPA_vect)
+#define CAP_ADC_DELAY_TIMER				2
+#elif defined(TIMER3_COMPA_vect)
+#define CAP_ADC_DELAY_TIMER				3
+#else
+#define CAP_ADC_DELAY_TIMER				0
+#endif
+#endif
+
+#if CAP_ADC_DELAY_TIMER == 2 && !defined(TIMER2_COMPA_vect)
+#error "CAP_ADC_DELAY_TIMER is 2, but this MCU has no timer 2"
+#elif CAP_ADC_DELAY_TIMER == 3 && !defined(TIMER3_COMPA_vect)
+#error "CAP_ADC_DELAY_TIMER is 3, but this MCU has no timer 3"
+#elif CAP_ADC_DELAY_TIMER != 0 && CAP_ADC_DELAY_TIMER != 2 && CAP_ADC_DELAY_TIMER != 3
+#error "CAP_ADC_DELAY_TIMER must be 0, 2 or 3"
+#endif
 
 class CapADCChannel{
 public:
@@ -28,15 +88,77 @@ public:
 
 	void init(uint8_t pin, uint8_t friendPin);
 
+	static const uint8_t NoDrive = 0xff;
+	void setDrivePin(uint8_t pin);
+	void setDrivePin(uint8_t *port, uint8_t mask);
+
 	void setChargeDelay(uint8_t value);
+	uint8_t getChargeDelay() const;
+
+	void setResolution(uint8_t bits);
+	uint8_t getResolution() const;
+
+	void setPrescaler(uint8_t value);
+	uint8_t getPrescaler() const;
+	uint8_t calibratePrescaler(uint8_t minRatio, uint8_t reads = 32);
+
+	void setSleepRead(bool value);
 
 	int16_t read();
 
+	bool start();
+	bool available() const;
+	int16_t getValue();
+
+	static bool isBusy();
+	static void handleInterrupt();
+	static void handleTimer();
+	static void service();
+	static void setDelayTimer(bool value);
+	static bool wakeAfter(uint32_t us, void (*callback)(void));
+	static void setCallback(void (*callback)(CapADCChannel*));
+
+	static void initADC();
+	static void setMux(uint8_t channel);
+	static void setADCMode(uint8_t bits, uint8_t prescaler = 0);
+	static uint16_t getConversion(uint8_t bits);
+
 protected:
+	// Phases of a non-blocking read sequence, sequenced by the ADC interrupt,
+	// and by the delay timer interrupt for the charge transfers when it is used.
+	enum phase_t{
+		Idle = 0,
+		Charge,					// 1
+		ChargeConversion,		// 2
+		Discharge,				// 3
+		DischargeConversion,	// 4
+		Done,					// 5
+	};
+
 //	uint8_t share();
-	void setMux(uint8_t channel);
+	bool startSequence(bool sleepConversions);
+	static void armTimer(uint32_t us);
+	void wait(uint8_t phase);
+	void nextPhase();
 
 	uint8_t _transfertDelay;
+	uint8_t _resolution;
+	uint8_t _prescaler;
+	bool _sleepRead;
+
+	volatile uint8_t _phase;
+	volatile int16_t _value;
+
+	// The channel currently owning the ADC, if any.
+	static CapADCChannel * volatile _active;
+	// Called from the interrupt each time a read sequence is done.
+	static void (*_callback)(CapADCChannel*);
+	// Charge transfers are timed by the delay timer.
+	static bool _delayTimer;
+	// Conversions are left to the sleep instruction, see read().
+	static bool _sleepConversions;
+	// Called from the delay timer interrupt when no channel uses it, see wakeAfter().
+	static void (* volatile _wake)(void);
 
 private:
 	uint8_t *_portRPin;
@@ -49,6 +171,10 @@ private:
 	uint8_t *_ddrRFriendPin;
 	uint8_t _maskFriendPin;
 
+	// Drive pin, for mutual capacitance. Mask is 0 when not used.
+	uint8_t *_portRDrivePin;
+	uint8_t _maskDrivePin;
+
 
 	uint8_t _channel;
 	uint8_t _friendChannel;
@@ -0,0 +1,79 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Generated by extras/capadc_config.py from library defaults.
+// Edit the settings file and generate this header again rather than editing it.
+
+#ifndef CAP_ADC_CONFIG_H
+#define CAP_ADC_CONFIG_H
+
+#include <stdint.h>
+
+// Global settings, shared by all sensors, and defaults of CapADCSetGlobal_t.
+// When fixed is true they are compile-time constants: update() uses them as immediates,
+// and applyGlobalSettings() doesn't change them anymore. The thresholds of CapADCConfigLocal
+// are then constants for every sensor too, see CapADCThresholds.
+struct CapADCConfigGlobal{
+	static constexpr bool fixed = false;
+	static constexpr uint8_t samples = 4;
+	static constexpr uint8_t divider = 1;
+	static constexpr uint8_t debounce = 2;
+	static constexpr uint8_t noiseIncrement = 1;
+	static constexpr uint16_t noiseCountRising = 50;
+	static constexpr uint16_t noiseCountFalling = 5;
+};
+
+// Defaults of CapADCSetLocal_t.
+struct CapADCConfigLocal{
+	static constexpr int16_t touchThreshold = 50;
+	static constexpr int16_t releaseThreshold = 40;
+	static constexpr uint8_t resetCounter = 255;
+	static constexpr int16_t proxThreshold = 0;
+	static constexpr int16_t proxReleaseThreshold = 0;
+};
+
+// Layout options. They add members to the library objects, so every file of the build must see
+// the same values: a define in a sketch doesn't reach the library files, and is refused.
+// Set them in the settings file, or for the whole build on the compiler command line
+// along with CAP_ADC_GLOBAL_OPTIONS.
+
+// Statistics on what sensors do, see CapacitiveADCStats.h.
+#if defined(CAP_ADC_STATS) && !defined(CAP_ADC_GLOBAL_OPTIONS)
+#error "CAP_ADC_STATS is set in CapacitiveADCConfig.h, generated from the settings file"
+#endif
+#ifndef CAP_ADC_STATS
+#define CAP_ADC_STATS			0
+#endif
+
+// Frames of sensor values, see CapacitiveADCTelemetry.h.
+#if defined(CAP_ADC_TELEMETRY) && !defined(CAP_ADC_GLOBAL_OPTIONS)
+#error "CAP_ADC_TELEMETRY is set in CapacitiveADCConfig.h, generated from the settings file"
+#endif
+#ifndef CAP_ADC_TELEMETRY
+#define CAP_ADC_TELEMETRY		0
+#endif
+
+// Size of the frame buffer, in bytes. A power of two, up to 256.
+#if defined(CAP_ADC_TELEMETRY_SIZE) && !defined(CAP_ADC_GLOBAL_OPTIONS)
+#error "CAP_ADC_TELEMETRY_SIZE is set in CapacitiveADCConfig.h, generated from the settings file"
+#endif
+#ifndef CAP_ADC_TELEMETRY_SIZE
+#define CAP_ADC_TELEMETRY_SIZE	128
+#endif
+
+#endif
@@ -0,0 +1,237 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAP_ADC_FAST_CHANNEL_H
+#define CAP_ADC_FAST_CHANNEL_H
+
+#include <Arduino.h>
+#include "CapacitiveADCChannel.h"
+
+// Compile-time description of a pin: port and direction registers, bit mask and ADC channel.
+// Only pins that are both digital I/O and ADC inputs are defined, so a wrong pin fails to compile.
+// As with CapADCChannel::init(), pins can be given as analog pin (A0) or channel number (0).
+template<uint8_t Pin>
+struct CapADCPinTraits;
+
+#define CAP_ADC_PIN_TRAITS(pinNumber, portLetter, bitNumber, adcChannel)		\
+	template<>																	\
+	struct CapADCPinTraits<pinNumber>{											\
+		static volatile uint8_t& port(){return PORT##portLetter;}				\
+		static volatile uint8_t& ddr(){return DDR##portLetter;}				\
+		static const uint8_t mask = _BV(bitNumber);								\
+		static const uint8_t channel = adcChannel;								\
+	};
+
+#if defined(__AVR_ATmega32U4__) && !defined(CORE_TEENSY)
+// Leonardo, Micro: A0 to A5
+CAP_ADC_PIN_TRAITS(18, F, 7, 7)
+CAP_ADC_PIN_TRAITS(19, F, 6, 6)
+CAP_ADC_PIN_TRAITS(20, F, 5, 5)
+CAP_ADC_PIN_TRAITS(21, F, 4, 4)
+CAP_ADC_PIN_TRAITS(22, F, 1, 1)
+CAP_ADC_PIN_TRAITS(23, F, 0, 0)
+CAP_ADC_PIN_TRAITS(0, F, 7, 7)
+CAP_ADC_PIN_TRAITS(1, F, 6, 6)
+CAP_ADC_PIN_TRAITS(2, F, 5, 5)
+CAP_ADC_PIN_TRAITS(3, F, 4, 4)
+CAP_ADC_PIN_TRAITS(4, F, 1, 1)
+CAP_ADC_PIN_TRAITS(5, F, 0, 0)
+
+#elif defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
+// Mega: A0 to A15
+CAP_ADC_PIN_TRAITS(54, F, 0, 0)
+CAP_ADC_PIN_TRAITS(55, F, 1, 1)
+CAP_ADC_PIN_TRAITS(56, F, 2, 2)
+CAP_ADC_PIN_TRAITS(57, F, 3, 3)
+CAP_ADC_PIN_TRAITS(58, F, 4, 4)
+CAP_ADC_PIN_TRAITS(59, F, 5, 5)
+CAP_ADC_PIN_TRAITS(60, F, 6, 6)
+CAP_ADC_PIN_TRAITS(61, F, 7, 7)
+CAP_ADC_PIN_TRAITS(62, K, 0, 8)
+CAP_ADC_PIN_TRAITS(63, K, 1, 9)
+CAP_ADC_PIN_TRAITS(64, K, 2, 10)
+CAP_ADC_PIN_TRAITS(65, K, 3, 11)
+CAP_ADC_PIN_TRAITS(66, K, 4, 12)
+CAP_ADC_PIN_TRAITS(67, K, 5, 13)
+CAP_ADC_PIN_TRAITS(68, K, 6, 14)
+CAP_ADC_PIN_TRAITS(69, K, 7, 15)
+CAP_ADC_PIN_TRAITS(0, F, 0, 0)
+CAP_ADC_PIN_TRAITS(1, F, 1, 1)
+CAP_ADC_PIN_TRAITS(2, F, 2, 2)
+CAP_ADC_PIN_TRAITS(3, F, 3, 3)
+CAP_ADC_PIN_TRAITS(4, F, 4, 4)
+CAP_ADC_PIN_TRAITS(5, F, 5, 5)
+CAP_ADC_PIN_TRAITS(6, F, 6, 6)
+CAP_ADC_PIN_TRAITS(7, F, 7, 7)
+CAP_ADC_PIN_TRAITS(8, K, 0, 8)
+CAP_ADC_PIN_TRAITS(9, K, 1, 9)
+CAP_ADC_PIN_TRAITS(10, K, 2, 10)
+CAP_ADC_PIN_TRAITS(11, K, 3, 11)
+CAP_ADC_PIN_TRAITS(12, K, 4, 12)
+CAP_ADC_PIN_TRAITS(13, K, 5, 13)
+CAP_ADC_PIN_TRAITS(14, K, 6, 14)
+CAP_ADC_PIN_TRAITS(15, K, 7, 15)
+
+#elif defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__) || defined(__AVR_ATmega168__)
+// Uno, Nano, Pro Mini: A0 to A5 (A6 and A7 have no digital function)
+CAP_ADC_PIN_TRAITS(14, C, 0, 0)
+CAP_ADC_PIN_TRAITS(15, C, 1, 1)
+CAP_ADC_PIN_TRAITS(16, C, 2, 2)
+CAP_ADC_PIN_TRAITS(17, C, 3, 3)
+CAP_ADC_PIN_TRAITS(18, C, 4, 4)
+CAP_ADC_PIN_TRAITS(19, C, 5, 5)
+CAP_ADC_PIN_TRAITS(0, C, 0, 0)
+CAP_ADC_PIN_TRAITS(1, C, 1, 1)
+CAP_ADC_PIN_TRAITS(2, C, 2, 2)
+CAP_ADC_PIN_TRAITS(3, C, 3, 3)
+CAP_ADC_PIN_TRAITS(4, C, 4, 4)
+CAP_ADC_PIN_TRAITS(5, C, 5, 5)
+
+#endif
+
+#undef CAP_ADC_PIN_TRAITS
+
+// A capacitive channel whose pins are known at compile time.
+// Port registers, masks and ADC channels are constants, so pin toggles compile
+// to single sbi / cbi instructions, and the only RAM used is the charge delay and ADC settings.
+// It uses the same charge transfer sequence as CapADCChannel::read(), polling the ADC.
+// read() returns 0 while a CapADCChannel, or the scanner, is using the ADC.
+// Use CapADCChannel when pins are chosen at runtime, or with the scanner.
+template<uint8_t Pin, uint8_t FriendPin>
+class CapADCFastChannel{
+public:
+	CapADCFastChannel():_transfertDelay(4), _resolution(10), _prescaler(0){}
+
+	void init(){
+		// Turn both pin OUTPUT, LOW.
+		pin::ddr() |= pin::mask;
+		pin::port() &= ~pin::mask;
+		friendPin::ddr() |= friendPin::mask;
+		friendPin::port() &= ~friendPin::mask;
+
+		CapADCChannel::initADC();
+	}
+
+	void setChargeDelay(uint8_t value){
+		_transfertDelay = value;
+	}
+
+	// 8 or 10 bits, see CapADCChannel::setResolution().
+	void setResolution(uint8_t bits){
+		_resolution = (bits == 8)?8:10;
+	}
+
+	// ADPS bits, see CapADCChannel::setPrescaler().
+	void setPrescaler(uint8_t value){
+		_prescaler = value & 0b111;
+	}
+
+	int16_t read(){
+		if(CapADCChannel::isBusy()) return 0;
+
+		// The ADC registers values are computed once, the channels being constants:
+		// each mux switch and each conversion start is then a single write.
+		// Reference kept, result left-adjusted for 8 bits so ADCH is enough.
+		const uint8_t admux = (ADMUX & (_BV(REFS1) | _BV(REFS0))) | ((_resolution == 8)?_BV(ADLAR):0);
+		// ADC enabled, no interrupt: conversions are polled.
+		// Prescaler 4 for 8 bits and 8 for 10 bits by default, as CapADCChannel::setADCMode().
+		const uint8_t adcsra = _BV(ADEN) | ((_prescaler != 0)?_prescaler:((_resolution == 8)?0b010:0b011));
+		ADCSRA = adcsra;
+#if defined(MUX5)
+		ADCSRB = _BV(7) | bank<friendPin>();
+#else
+		ADCSRB |= _BV(7);
+#endif
+
+		// Discharge the ADC s&h cap by linking it to the friend pin, LOW.
+		friendPin::port() &= ~friendPin::mask;
+		select<friendPin>(admux);
+
+		// Charge the electrode.
+		pin::port() |= pin::mask;
+		CAP_ADC_DELAY_US(_transfertDelay);
+
+		// Share the electrode charge with the s&h cap, and convert.
+		pin::ddr() &= ~pin::mask;
+		pin::port() &= ~pin::mask;
+		select<pin>(admux);
+		int16_t value = convert(adcsra);
+
+		// Charge the s&h cap from the friend pin, HIGH.
+		select<friendPin>(admux);
+		friendPin::port() |= friendPin::mask;
+
+		// Discharge the electrode.
+		pin::ddr() |= pin::mask;
+		pin::port() &= ~pin::mask;
+		CAP_ADC_DELAY_US(_transfertDelay);
+
+		// Share the s&h cap charge with the electrode, and convert.
+		pin::ddr() &= ~pin::mask;
+		pin::port() &= ~pin::mask;
+		select<pin>(admux);
+		value -= convert(adcsra);
+
+		pin::ddr() |= pin::mask;
+		pin::port() &= ~pin::mask;
+		friendPin::ddr() |= friendPin::mask;
+		friendPin::port() &= ~friendPin::mask;
+
+		return value;
+	}
+
+protected:
+	typedef CapADCPinTraits<Pin> pin;
+	typedef CapADCPinTraits<FriendPin> friendPin;
+
+#if defined(MUX5)
+	// MUX5 bit of ADCSRB for a pin: channels 8 to 15 are in the second bank.
+	template<typename P>
+	static uint8_t bank(){
+		return (P::channel & 0x08)?_BV(MUX5):0;
+	}
+#endif
+
+	// Set the ADC to a pin channel, in one write as CapADCChannel::setMux().
+	// ADCSRB is only written when both pins are not in the same bank.
+	template<typename P>
+	static void select(uint8_t admux){
+#if defined(MUX5)
+		if((pin::channel & 0x08) != (friendPin::channel & 0x08)) ADCSRB = _BV(7) | bank<P>();
+#endif
+		ADMUX = admux | (P::channel & 0x07);
+	}
+
+	// Launch a conversion, and wait for it to be done.
+	int16_t convert(uint8_t adcsra){
+		ADCSRA = adcsra | _BV(ADSC);
+		while(ADCSRA & _BV(ADSC));
+
+		if(_resolution == 8) return ADCH;
+
+		uint16_t value = ADCL;
+		value += ((uint16_t)ADCH << 8);
+		return value;
+	}
+
+	uint8_t _transfertDelay;
+	uint8_t _resolution;
+	uint8_t _prescaler;
+};
+
+#endif
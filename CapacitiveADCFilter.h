@@ -0,0 +1,156 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAP_ADC_FILTER_H
+#define CAP_ADC_FILTER_H
+
+#include <Arduino.h>
+
+// Filter policies used on reads by pins, sliders and wheels.
+// Each policy keeps its own state, filters one value per update with apply(),
+// and can be reset() to a value, as if it had been read for long.
+// None of them divides: weights are powers of two or fractions of 256.
+
+// Exponential filter, with a weight of 1 / 2^Shift for the new value.
+// The cheapest one, but the state has no fractional part:
+// a change smaller than 2^Shift is not seen.
+template<uint8_t Shift>
+class CapADCFilterShift{
+public:
+	CapADCFilterShift():_state(0){}
+
+	void reset(uint16_t value){
+		_state = value;
+	}
+
+	uint16_t apply(uint16_t value){
+		_state += ((int16_t)(value - _state)) >> Shift;
+		return _state;
+	}
+
+protected:
+	uint16_t _state;
+};
+
+// First order IIR filter, with a weight of Weight / 256 for the new value.
+// It is the exponential filter the library always used, with 8 bits of fractional state
+// so small changes still accumulate. Weight 40 behaves as the former expWeight default.
+template<uint8_t Weight>
+class CapADCFilterIIR{
+public:
+	CapADCFilterIIR():_state(0){}
+
+	void reset(uint16_t value){
+		_state = (int32_t)value << 8;
+	}
+
+	uint16_t apply(uint16_t value){
+		int32_t diff = ((int32_t)value << 8) - _state;
+		// diff * Weight / 256, split in high and low bytes to stay on 32 bits.
+		_state += (diff >> 8) * Weight + (((uint16_t)(uint8_t)diff * Weight) >> 8);
+		// Round to the nearest integer.
+		return (_state + 128) >> 8;
+	}
+
+protected:
+	int32_t _state;
+};
+
+// Helper to get the shift matching a power of two.
+template<uint8_t Value>
+struct CapADCLog2{
+	static const uint8_t value = 1 + CapADCLog2<Value / 2>::value;
+};
+
+template<>
+struct CapADCLog2<1>{
+	static const uint8_t value = 0;
+};
+
+// Moving average on the Size last values. Size must be a power of two.
+// Smoother than exponential filters, but uses 2 * Size bytes of RAM.
+template<uint8_t Size>
+class CapADCFilterBoxcar{
+public:
+	CapADCFilterBoxcar(){
+		reset(0);
+	}
+
+	void reset(uint16_t value){
+		for(uint8_t i = 0; i < Size; ++i){
+			_values[i] = value;
+		}
+		_sum = (uint32_t)value * Size;
+		_index = 0;
+	}
+
+	uint16_t apply(uint16_t value){
+		_sum += value;
+		_sum -= _values[_index];
+		_values[_index] = value;
+		_index = (_index + 1) & (Size - 1);
+		return _sum >> CapADCLog2<Size>::value;
+	}
+
+protected:
+	static_assert(Size != 0 && (Size & (Size - 1)) == 0, "Boxcar size must be a power of two");
+
+	uint16_t _values[Size];
+	uint32_t _sum;
+	uint8_t _index;
+};
+
+// Median of the three last values. Removes spikes without smoothing edges.
+class CapADCFilterMedian3{
+public:
+	CapADCFilterMedian3():_a(0), _b(0){}
+
+	void reset(uint16_t value){
+		_a = _b = value;
+	}
+
+	uint16_t apply(uint16_t value){
+		uint16_t a = _a;
+		uint16_t b = _b;
+		_a = _b;
+		_b = value;
+
+		if(a > b){
+			uint16_t t = a;
+			a = b;
+			b = t;
+		}
+		if(value <= a) return a;
+		if(value >= b) return b;
+		return value;
+	}
+
+protected:
+	uint16_t _a;
+	uint16_t _b;
+};
+
+// The filter used by the library.
+// It can be defined on the compiler command line to any of the policies above.
+#ifndef CAP_ADC_FILTER
+#define CAP_ADC_FILTER		CapADCFilterIIR<40>
+#endif
+
+typedef CAP_ADC_FILTER CapADCFilter;
+
+#endif
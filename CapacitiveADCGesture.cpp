@@ -0,0 +1,130 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CapacitiveADCGesture.h"
+
+// Time between the travel samples used for velocity, in ms.
+#define CAP_ADC_GESTURE_WINDOW		40
+
+// Public methods
+
+// Constructor
+CapADCGesture::CapADCGesture(){
+	_tapTime = 250;
+	_doubleTapTime = 300;
+	_longPressTime = 800;
+	_tapMove = 8;
+	_swipeMove = 40;
+
+	_touched = _longPressed = _tapPending = false;
+	_lastPosition = 0;
+	_travel = 0;
+	_touchTime = _lastTime = _tapEnd = 0;
+	_anchorTravel = _prevAnchorTravel = 0;
+	_anchorTime = _prevAnchorTime = 0;
+
+	_gesture = None;
+	_velocity = 0;
+}
+
+// Feed the recognizer with a slider or wheel, once after each of its updates.
+// The touch starts once the slider has a position for it: on the first touched update,
+// getPosition() is still the one of the last touch.
+uint8_t CapADCGesture::update(const CapADCSliderBase& slider){
+	return update(slider.hasPosition(), slider.getPosition());
+}
+
+// Feed the recognizer with a touch state and position, at a given time (ms).
+// Returns the gesture recognized on this update, None most of the time.
+// A tap is reported as soon as the finger leaves; a second one soon after is reported as a double tap.
+// A swipe is a touch that travelled far enough, getVelocity() then gives its speed at release,
+// in position units per second, signed.
+uint8_t CapADCGesture::update(bool touched, int8_t position, uint32_t now){
+	uint8_t gesture = None;
+
+	if(touched && !_touched){
+		// New touch.
+		_touched = true;
+		_longPressed = false;
+		_lastPosition = position;
+		_travel = 0;
+		_touchTime = _lastTime = now;
+		_anchorTravel = _prevAnchorTravel = 0;
+		_anchorTime = _prevAnchorTime = now;
+
+	} else if(touched){
+		// Moves are computed on 8 bits, so wheels wrap.
+		_travel += (int8_t)(position - _lastPosition);
+		_lastPosition = position;
+		_lastTime = now;
+
+		if((now - _anchorTime) >= CAP_ADC_GESTURE_WINDOW){
+			_prevAnchorTravel = _anchorTravel;
+			_prevAnchorTime = _anchorTime;
+			_anchorTravel = _travel;
+			_anchorTime = now;
+		}
+
+		if(!_longPressed && ((now - _touchTime) >= _longPressTime) && (abs(_travel) <= _tapMove)){
+			_longPressed = true;
+			_tapPending = false;
+			gesture = LongPress;
+		}
+
+	} else if(_touched){
+		_touched = false;
+		gesture = release(now);
+	}
+
+	if(gesture != None) _gesture = gesture;
+
+	return gesture;
+}
+
+// Protected methods
+
+// Sort out what the touch that just ended was.
+uint8_t CapADCGesture::release(uint32_t now){
+	if(abs(_travel) >= _swipeMove){
+		// Velocity up to the last touched update, over at least a full window.
+		uint32_t time = _lastTime - _prevAnchorTime;
+		int32_t travel = _travel - _prevAnchorTravel;
+		if(time == 0) time = 1;
+		int32_t velocity = (travel * 1000) / (int32_t)time;
+		if(velocity > 32767) velocity = 32767;
+		if(velocity < -32767) velocity = -32767;
+		_velocity = velocity;
+
+		_tapPending = false;
+		return (_travel > 0)?SwipeUp:SwipeDown;
+	}
+
+	if(_longPressed || abs(_travel) > _tapMove || (now - _touchTime) > _tapTime){
+		_tapPending = false;
+		return None;
+	}
+
+	if(_tapPending && (_touchTime - _tapEnd) <= _doubleTapTime){
+		_tapPending = false;
+		return DoubleTap;
+	}
+
+	_tapPending = true;
+	_tapEnd = now;
+	return Tap;
+}
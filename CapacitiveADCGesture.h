@@ -0,0 +1,89 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAP_ADC_GESTURE_H
+#define CAP_ADC_GESTURE_H
+
+#include <Arduino.h>
+#include "CapacitiveADCSlider.h"
+
+// Gesture recognizer, fed with the touch state and position of a slider or wheel on each update.
+// It reports taps, double taps, long presses and swipes, with the swipe velocity.
+// It keeps a few bytes of state, and each update costs the same whatever the history:
+// the only division is made once per swipe, to compute its velocity.
+// Positions are the int8_t ones of sliders and wheels: moves are computed on 8 bits,
+// so a wheel crossing its origin is seen as a short move. The travel sums them on 32 bits:
+// a wheel can turn for millions of turns without it wrapping.
+class CapADCGesture{
+public:
+
+	enum gesture_t{
+		None = 0,
+		Tap,					// 1
+		DoubleTap,				// 2
+		LongPress,				// 3
+		SwipeUp,				// 4, toward positive positions
+		SwipeDown,				// 5, toward negative positions
+	};
+
+	CapADCGesture();
+
+	uint8_t update(const CapADCSliderBase& slider);
+	uint8_t update(bool touched, int8_t position, uint32_t now = CAP_ADC_MILLIS());
+
+	uint8_t getGesture() const{return _gesture;}
+	int16_t getVelocity() const{return _velocity;}
+	int32_t getTravel() const{return _travel;}
+
+	void setTapTime(uint16_t value){_tapTime = value;}
+	void setDoubleTapTime(uint16_t value){_doubleTapTime = value;}
+	void setLongPressTime(uint16_t value){_longPressTime = value;}
+	void setTapMove(uint8_t value){_tapMove = value;}
+	void setSwipeMove(uint8_t value){_swipeMove = value;}
+
+protected:
+	uint8_t release(uint32_t now);
+
+	// Settings: times in ms, moves in position units
+	uint16_t _tapTime;
+	uint16_t _doubleTapTime;
+	uint16_t _longPressTime;
+	uint8_t _tapMove;
+	uint8_t _swipeMove;
+
+	// Current touch
+	bool _touched;
+	bool _longPressed;
+	int8_t _lastPosition;
+	int32_t _travel;
+	uint32_t _touchTime;
+	uint32_t _lastTime;
+
+	// Two travel samples, at least a velocity window apart, to get the velocity at release
+	int32_t _anchorTravel, _prevAnchorTravel;
+	uint32_t _anchorTime, _prevAnchorTime;
+
+	// End of the last tap, for double taps
+	uint32_t _tapEnd;
+	bool _tapPending;
+
+	uint8_t _gesture;
+	int16_t _velocity;
+};
+
+#endif
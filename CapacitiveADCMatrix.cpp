@@ -0,0 +1,426 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CapacitiveADCMatrix.h"
+
+// Public methods
+
+// Constructor
+// Channels, keys and row pins are owned by the derived class, that gives them here.
+CapADCMatrixBase::CapADCMatrixBase(CapADCChannel *channels, CapADCSegment_t *keys, uint8_t **rowPorts,
+									uint8_t *rowMasks, uint8_t numRows, uint8_t numCols){
+	_adcChannel = channels;
+	_key = keys;
+	_rowPort = rowPorts;
+	_rowMask = rowMasks;
+	_numRows = numRows;
+	_numCols = numCols;
+
+	_resetCounter = 60;
+	_scanBudget = 0;
+	_keyRow = 0;
+	_keyCol = 0;
+	_scanStart = 0;
+	_scanTime = 0;
+	_touched = false;
+}
+
+// Init the object. Tie it to used pins.
+// Each column uses the next one as friend pin, the last one uses the first.
+void CapADCMatrixBase::initPins(const uint8_t *rows, const uint8_t *cols){
+	for(uint8_t i = 0; i < _numCols; ++i){
+		uint8_t next = (i + 1 < _numCols)?(i + 1):0;
+		_adcChannel[i].init(cols[i], cols[next]);
+	}
+
+	// Rows are all set OUTPUT, LOW, so the ones not driven shield the others.
+	for(uint8_t i = 0; i < _numRows; ++i){
+		_rowPort[i] = (uint8_t*)portOutputRegister(digitalPinToPort(rows[i]));
+		_rowMask[i] = digitalPinToBitMask(rows[i]);
+		pinMode(rows[i], OUTPUT);
+		digitalWrite(rows[i], LOW);
+	}
+}
+
+// change the charge delay for all columns
+void CapADCMatrixBase::setChargeDelay(uint8_t value){
+	for(uint8_t i = 0; i < _numCols; ++i){
+		_adcChannel[i].setChargeDelay(value);
+	}
+}
+
+// Change the resolution (8 or 10 bits) for all columns.
+void CapADCMatrixBase::setResolution(uint8_t bits){
+	for(uint8_t i = 0; i < _numCols; ++i){
+		_adcChannel[i].setResolution(bits);
+	}
+}
+
+// Change the ADC prescaler for all columns.
+void CapADCMatrixBase::setPrescaler(uint8_t value){
+	for(uint8_t i = 0; i < _numCols; ++i){
+		_adcChannel[i].setPrescaler(value);
+	}
+}
+
+// Tune baseline.
+// Take an amount of readings of all keys in turn, and average them to get their baselines.
+// This blocks for length ms, use startTuneBaseline() to keep the loop running.
+void CapADCMatrixBase::tuneBaseline(uint32_t length){
+	startTuneBaseline(length);
+	while(isTuning()) update();
+}
+
+// Tune threshold.
+// Tune baseline, then read keys for a given time, compute the max delta
+// and set threshold values for touch.
+// This blocks, use startTuneThreshold() to keep the loop running.
+void CapADCMatrixBase::tuneThreshold(uint32_t length){
+	startTuneThreshold(length);
+	while(isTuning()) update();
+}
+
+// Start tuning baseline, without blocking.
+void CapADCMatrixBase::startTuneBaseline(uint32_t length){
+	startTune(length, 0);
+	resetTune();
+}
+
+// Start tuning baseline then threshold, without blocking.
+void CapADCMatrixBase::startTuneThreshold(uint32_t length){
+	startTune(200, length);
+	resetTune();
+}
+
+// Scan the keys, all of them or the ones the scan budget allows. Returns the number of keys touched.
+int16_t CapADCMatrixBase::update(void){
+	// While tuning, readings go to the tuning.
+	if(_tuneState != TuneIdle){
+		updateTune();
+		return 0;
+	}
+
+	uint32_t statsTime = statsStart();
+	uint32_t start = CAP_ADC_MICROS();
+	uint8_t read = 0;
+
+	// Just touched and released tell about the keys read by this update only.
+	for(uint8_t i = 0; i < _numRows * _numCols; ++i){
+		_key[i].previousState = _key[i].state;
+	}
+
+	do{
+		if(_keyRow == 0 && _keyCol == 0) _scanStart = CAP_ADC_MICROS();
+		updateKey(_keyRow, _keyCol);
+		++read;
+		if(nextKey()) _scanTime = CAP_ADC_MICROS() - _scanStart;
+	} while(keyFits(read, start));
+
+	int16_t touched = 0;
+	for(uint8_t i = 0; i < _numRows * _numCols; ++i){
+		if(_key[i].state == Touch) ++touched;
+	}
+
+	// The matrix is touched as long as one of its keys is, getKey() tells which.
+	bool wasTouched = _touched;
+	_touched = (touched != 0);
+	if(_touched != wasTouched) eventTransition(_touched?Touch:Idle, wasTouched?Touch:Idle);
+	eventLongPress();
+
+	statsUpdate(statsTime);
+
+	return touched;
+}
+
+// Limit the time update() takes, in µs. 0, the default, reads every key on each update().
+// With a budget, update() reads keys in turn while the average key read so far fits,
+// so it lasts at most the budget, key reads lasting the same but for interrupts.
+// It always reads one key: a budget shorter than a key read is exceeded by that read.
+// A full scan then spans several updates, getScanTime() tells how long it takes,
+// and keys are debounced over as many of their own reads as with full scans.
+// Tuning reads keys within the budget too.
+void CapADCMatrixBase::setScanBudget(uint16_t us){
+	_scanBudget = us;
+}
+
+// Getter for touch state
+bool CapADCMatrixBase::isTouched(uint8_t row, uint8_t col) const{
+	if(_key[row * _numCols + col].state == Touch) return true;
+	return false;
+}
+
+// Getter for touch state
+bool CapADCMatrixBase::isJustTouched(uint8_t row, uint8_t col) const{
+	const CapADCSegment_t &key = _key[row * _numCols + col];
+	if((key.state == Touch) && (key.previousState != Touch)) return true;
+	return false;
+}
+
+// Getter for touch state
+bool CapADCMatrixBase::isJustReleased(uint8_t row, uint8_t col) const{
+	const CapADCSegment_t &key = _key[row * _numCols + col];
+	if((key.state != Touch) && (key.previousState == Touch)) return true;
+	return false;
+}
+
+// Index (row * columns + column) of the first key touched, NoKey if none.
+uint8_t CapADCMatrixBase::getKey(void) const{
+	for(uint8_t i = 0; i < _numRows * _numCols; ++i){
+		if(_key[i].state == Touch) return i;
+	}
+
+	return NoKey;
+}
+
+uint16_t CapADCMatrixBase::getBaseline(uint8_t row, uint8_t col) const{
+	return _key[row * _numCols + col].baseline;
+}
+
+int16_t CapADCMatrixBase::getDelta(uint8_t row, uint8_t col) const{
+	return _key[row * _numCols + col].delta;
+}
+
+// Protected methods
+
+// Read a key, filter it and update its state.
+void CapADCMatrixBase::updateKey(uint8_t row, uint8_t col){
+	uint8_t i = row * _numCols + col;
+	CapADCSegment_t &key = _key[i];
+
+	uint16_t raw = updateRead(row, col);
+	key.currentRead = key.filter.apply(raw);
+
+	// A finger lowers the coupling: the delta is positive when touched.
+	key.delta = key.baseline - key.currentRead;
+	key.prevState = key.nowState;
+
+	if(key.delta > localTouchThreshold()){
+		key.nowState = Touch;
+	} else if(key.delta > 0){
+		key.nowState = Rising;
+	} else if(key.delta < 0){
+		key.nowState = Falling;
+	} else {
+		key.nowState = Idle;
+	}
+
+	if(key.nowState != key.prevState) key.lastTime = CAP_ADC_MILLIS();
+
+	if(key.nowState == Rising || key.nowState == Falling) updateCal(i);
+
+	// Debounce the current instant state to see if we can use it to detect touch
+	if((key.nowState == key.prevState) && ((CAP_ADC_MILLIS() - key.lastTime) > globalDebounce())){
+		key.previousState = key.state;
+		key.state = key.nowState;
+		if(key.state != key.previousState) statsTransition();
+	} else if(key.nowState != key.state){
+		statsDebounce();
+	}
+
+	telemetry(i, key.state, raw, key.currentRead, key.baseline, key.delta);
+}
+
+// Move to the next key, row after row. Returns true when a full scan is done.
+bool CapADCMatrixBase::nextKey(void){
+	if(++_keyCol < _numCols) return false;
+	_keyCol = 0;
+	if(++_keyRow < _numRows) return false;
+	_keyRow = 0;
+	return true;
+}
+
+// Whether update() reads another key, read keys being read since start.
+// Without budget, until every key is read. With a budget, while one more key read,
+// as long as the average of the ones read so far, still fits in it.
+bool CapADCMatrixBase::keyFits(uint8_t read, uint32_t start) const{
+	if(read >= _numRows * _numCols) return false;
+	if(_scanBudget == 0) return true;
+
+	uint32_t elapsed = CAP_ADC_MICROS() - start;
+	return elapsed + elapsed / read <= _scanBudget;
+}
+
+// Feed the running tuning with readings of the keys, all of them or the ones the budget allows.
+void CapADCMatrixBase::updateTune(void){
+	uint32_t elapsed = tuneElapsed();
+	uint8_t numKeys = _numRows * _numCols;
+	uint32_t start = CAP_ADC_MICROS();
+	uint8_t read = 0;
+
+	if(_tuneState == TuneBaseline){
+		do{
+			CapADCSegment_t &key = _key[_keyRow * _numCols + _keyCol];
+			key.tuneSum += updateRead(_keyRow, _keyCol);
+			++key.tuneCount;
+			++read;
+			nextKey();
+		} while(keyFits(read, start));
+
+		if(elapsed < _tuneBaselineLength) return;
+
+		for(uint8_t i = 0; i < numKeys; ++i){
+			CapADCSegment_t &key = _key[i];
+			if(key.tuneCount != 0) key.baseline = key.tuneSum / key.tuneCount;
+			key.currentRead = key.baseline;
+			key.filter.reset(key.baseline);
+			key.tuneMin = key.tuneMax = key.baseline;
+		}
+
+		_tuneState = (_tuneThresholdLength != 0)?TuneThreshold:TuneIdle;
+
+	} else if(_tuneState == TuneThreshold){
+		do{
+			CapADCSegment_t &key = _key[_keyRow * _numCols + _keyCol];
+			uint16_t current = updateRead(_keyRow, _keyCol);
+			if(key.tuneMin > current) key.tuneMin = current;
+			if(key.tuneMax < current) key.tuneMax = current;
+			++read;
+			nextKey();
+		} while(keyFits(read, start));
+
+		if(elapsed < _tuneBaselineLength + _tuneThresholdLength) return;
+
+		// Thresholds are set from the average noise amplitude: touch at 40%, release at 60% of touch.
+		uint32_t delta = 0;
+		for(uint8_t i = 0; i < numKeys; ++i){
+			delta += _key[i].tuneMax - _key[i].tuneMin;
+		}
+
+		delta /= numKeys;
+
+		uint16_t touch = (delta * 2) / 5;
+		uint16_t release = ((uint32_t)touch * 3) / 5;
+
+		setTouchThreshold(touch);
+		setReleaseThreshold(release);
+
+		_tuneState = TuneIdle;
+	}
+}
+
+// Clear the values gathered by a previous tuning. Tuning starts from the first key.
+void CapADCMatrixBase::resetTune(void){
+	for(uint8_t i = 0; i < _numRows * _numCols; ++i){
+		_key[i].tuneSum = 0;
+		_key[i].tuneCount = 0;
+	}
+	_keyRow = 0;
+	_keyCol = 0;
+}
+
+// Number of keys stored by saveCalibration().
+uint8_t CapADCMatrixBase::getStoredCount(void) const{
+	return _numRows * _numCols;
+}
+
+// Give the calibration of a key to be stored.
+void CapADCMatrixBase::saveChannel(uint8_t index, CapADCStoredChannel_t& stored){
+	CapADCChannel &channel = _adcChannel[index % _numCols];
+	stored.baseline = _key[index].baseline;
+	stored.chargeDelay = channel.getChargeDelay();
+	stored.prescaler = channel.getPrescaler();
+	stored.resolution = channel.getResolution();
+}
+
+// Check a reading of a key with its stored ADC settings is close enough to its stored baseline.
+// The current ADC settings of its column are put back afterwards.
+bool CapADCMatrixBase::checkChannel(uint8_t index, const CapADCStoredChannel_t& stored, uint16_t maxDrift){
+	uint8_t col = index % _numCols;
+	CapADCChannel &channel = _adcChannel[col];
+	uint8_t chargeDelay = channel.getChargeDelay();
+	uint8_t prescaler = channel.getPrescaler();
+	uint8_t resolution = channel.getResolution();
+
+	channel.setChargeDelay(stored.chargeDelay);
+	channel.setPrescaler(stored.prescaler);
+	channel.setResolution(stored.resolution);
+
+	uint16_t current = updateRead(index / _numCols, col);
+	uint16_t drift = (current > stored.baseline)?(current - stored.baseline):(stored.baseline - current);
+
+	channel.setChargeDelay(chargeDelay);
+	channel.setPrescaler(prescaler);
+	channel.setResolution(resolution);
+
+	return drift <= maxDrift;
+}
+
+// Apply the stored calibration of a key. Keys of a column share its ADC settings:
+// they were saved from the same channel, so each key sets them the same.
+void CapADCMatrixBase::restoreChannel(uint8_t index, const CapADCStoredChannel_t& stored){
+	CapADCChannel &channel = _adcChannel[index % _numCols];
+	channel.setChargeDelay(stored.chargeDelay);
+	channel.setPrescaler(stored.prescaler);
+	channel.setResolution(stored.resolution);
+
+	CapADCSegment_t &key = _key[index];
+	key.baseline = stored.baseline;
+	key.currentRead = key.baseline;
+	key.filter.reset(key.baseline);
+	key.tuneMin = key.tuneMax = key.baseline;
+}
+
+// Update the baseline value.
+// The delta is reversed compared to pins: baseline goes down when rising, up when falling.
+void CapADCMatrixBase::updateCal(uint8_t index){
+	CapADCSegment_t &key = _key[index];
+	uint16_t timeDelta = CAP_ADC_MILLIS() - key.lastTime;
+	if(key.nowState == Rising){
+		if(timeDelta >= globalNoiseCountRising()){
+			key.baseline -= globalNoiseIncrement();
+			key.lastTime = CAP_ADC_MILLIS();
+			statsBaseline();
+		}
+	} else if(key.nowState == Falling){
+		if(timeDelta >= globalNoiseCountFalling()){
+			key.baseline += globalNoiseIncrement();
+			key.lastTime = CAP_ADC_MILLIS();
+			statsBaseline();
+		}
+	}
+}
+
+// Get a serie of readings from a key: its column, with its row driven.
+uint16_t CapADCMatrixBase::updateRead(uint8_t row, uint8_t col){
+	uint32_t statsTime = statsStart();
+	int32_t value = 0;
+	uint16_t samples = 1 << globalSamples();
+	CapADCChannel &channel = _adcChannel[col];
+
+	channel.setDrivePin(_rowPort[row], _rowMask[row]);
+
+	if(channel.getResolution() == 8 && globalSamples() <= 7){
+		// 8 bits mutual reads are 0 to 510, they can be summed on 16 bits unsigned, which is faster.
+		uint16_t sum = 0;
+		for(uint16_t i = 0; i < samples; ++i){
+			sum += channel.read();
+		}
+		value = sum;
+	} else {
+		for(uint16_t i = 0; i < samples; ++i){
+			value += channel.read();
+		}
+	}
+
+	// Divide by 2^divider, shifting is much faster than a 32 bits division.
+	value >>= globalDivider();
+
+	statsRead(statsTime, samples);
+
+	return (uint16_t)value;
+}
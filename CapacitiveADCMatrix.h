@@ -0,0 +1,132 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAP_ADC_MATRIX_H
+#define CAP_ADC_MATRIX_H
+
+#include <Arduino.h>
+#include "CapacitiveADC.h"
+#include "CapacitiveADCSlider.h"
+
+// Matrix keypad logic, for any number of rows and columns.
+// Each key is the crossing of a row electrode, driven by a digital pin, and a column electrode,
+// read by an ADC pin: the mutual capacitance between them is measured, and a finger lowers it.
+// A keypad of R x C keys needs R + C pins, e.g. 8 pins for 16 keys.
+// Every key read is the same sequence, so a full scan always lasts the same time:
+// R x C x 2^samples reads. update() blocks for a full scan, unless setScanBudget() limits it:
+// it then reads the keys that fit, and the next update() goes on from there.
+// Storage for channels and keys is given by the derived class, sized to its rows and columns.
+class CapADCMatrixBase: public CapADC{
+public:
+
+	static const uint8_t NoKey = 0xff;
+
+	void setChargeDelay(uint8_t value);
+	void setResolution(uint8_t bits);
+	void setPrescaler(uint8_t value);
+
+	void tuneBaseline(uint32_t length = 200);
+	void tuneThreshold(uint32_t length = 2000);
+	void startTuneBaseline(uint32_t length = 200);
+	void startTuneThreshold(uint32_t length = 2000);
+
+	int16_t update(void);
+
+	void setScanBudget(uint16_t us);
+	uint16_t getScanBudget(void) const{return _scanBudget;}
+
+	bool isTouched(uint8_t row, uint8_t col) const;
+	bool isJustTouched(uint8_t row, uint8_t col) const;
+	bool isJustReleased(uint8_t row, uint8_t col) const;
+	uint8_t getKey(void) const;
+
+	uint16_t getBaseline(uint8_t row, uint8_t col) const;
+	int16_t getDelta(uint8_t row, uint8_t col) const;
+	uint32_t getScanTime(void) const{return _scanTime;}
+
+	uint8_t getNumRows(void) const{return _numRows;}
+	uint8_t getNumCols(void) const{return _numCols;}
+
+protected:
+	CapADCMatrixBase(CapADCChannel *channels, CapADCSegment_t *keys, uint8_t **rowPorts,
+						uint8_t *rowMasks, uint8_t numRows, uint8_t numCols);
+
+	void initPins(const uint8_t *rows, const uint8_t *cols);
+
+	void updateKey(uint8_t row, uint8_t col);
+	uint16_t updateRead(uint8_t row, uint8_t col);
+	void updateCal(uint8_t index);
+	void updateTune(void);
+	void resetTune(void);
+
+	bool nextKey(void);
+	bool keyFits(uint8_t read, uint32_t start) const;
+
+	// Calibration is stored per key: its baseline, and the ADC settings of its column.
+	uint8_t getStoredCount(void) const;
+	void saveChannel(uint8_t index, CapADCStoredChannel_t& stored);
+	bool checkChannel(uint8_t index, const CapADCStoredChannel_t& stored, uint16_t maxDrift);
+	void restoreChannel(uint8_t index, const CapADCStoredChannel_t& stored);
+
+	// The column channels, numCols of them
+	CapADCChannel *_adcChannel;
+	// State of each key, row after row
+	CapADCSegment_t *_key;
+	// The row drive pins output registers and masks, numRows of them,
+	// so switching rows doesn't look the pins up for every key.
+	uint8_t **_rowPort;
+	uint8_t *_rowMask;
+
+	uint8_t _numRows;
+	uint8_t _numCols;
+
+	// Scan budget in µs, 0 for full scans, and the next key to read
+	uint16_t _scanBudget;
+	uint8_t _keyRow;
+	uint8_t _keyCol;
+
+	uint32_t _scanStart;
+	uint32_t _scanTime;
+	bool _touched;
+};
+
+// A matrix keypad of Rows x Cols keys.
+// Use it as CapADCMatrix<4, 4> keypad; then keypad.init(rowPins, colPins);
+// Column pins must be ADC pins, row pins any digital pin.
+template<uint8_t Rows, uint8_t Cols>
+class CapADCMatrix: public CapADCMatrixBase{
+public:
+	CapADCMatrix(void):CapADCMatrixBase(_channels, _keys, _rowPorts, _rowMasks, Rows, Cols){}
+
+	// Init the object. Tie it to used pins, rows and columns in order.
+	void init(const uint8_t (&rows)[Rows], const uint8_t (&cols)[Cols]){
+		initPins(rows, cols);
+	}
+
+protected:
+	static_assert(Rows >= 1, "A matrix needs at least one row");
+	static_assert(Cols >= 2, "A matrix needs at least two columns, each one is the friend of another");
+	static_assert(Rows * Cols < NoKey, "A matrix can't have more than 254 keys");
+
+	CapADCChannel _channels[Cols];
+	CapADCSegment_t _keys[Rows * Cols];
+	uint8_t *_rowPorts[Rows];
+	uint8_t _rowMasks[Rows];
+};
+
+#endif
@@ -22,92 +22,101 @@
 
 // Constructor
 CapADCPin::CapADCPin():_baseline(200){
-	_adcChannel = new CapADCChannel();
+	_scanIndex = CapADCScanner::NoIndex;
 	_now = _prev = _state = _previousState = Idle;
-	_lSettings.resetCounter = 10;
-	_lastTime = millis();
-}
-
-// Destructor
-CapADCPin::~CapADCPin(){
-	delete _adcChannel;
+	_resetCounter = 10;
+	_lastTime = CAP_ADC_MILLIS();
+	_tuneSum = 0;
+	_tuneCount = 0;
+	_tuneMin = _tuneMax = 0;
 }
 
 // Init the object. Tie it to used pins.
 void CapADCPin::init(uint8_t pin, uint8_t friendPin){
-	_adcChannel->init(pin, friendPin);
+	_adcChannel.init(pin, friendPin);
 }
 
 // change the charge delay for this channel
 void CapADCPin::setChargeDelay(uint8_t value){
-	_adcChannel->setChargeDelay(value);
+	_adcChannel.setChargeDelay(value);
 }
 
+// Change the resolution (8 or 10 bits) for this channel.
+void CapADCPin::setResolution(uint8_t bits){
+	_adcChannel.setResolution(bits);
+}
+
+// Change the ADC prescaler for this channel.
+void CapADCPin::setPrescaler(uint8_t value){
+	_adcChannel.setPrescaler(value);
+}
+
+// Read in ADC noise reduction sleep mode.
+void CapADCPin::setSleepRead(bool value){
+	_adcChannel.setSleepRead(value);
+}
+
+// Register the channel to the scanner. Reads are then taken from the last scan
+// instead of being made on each update. Call before CapADCScanner::begin().
+bool CapADCPin::attachScanner(){
+	if(_scanIndex == CapADCScanner::NoIndex) _scanIndex = CapADCScanner::add(&_adcChannel);
+	return _scanIndex != CapADCScanner::NoIndex;
+}
+
+
+// Tune prescaler.
+// Select the fastest ADC clock for which the signal is at least minRatio times the noise.
+// Do it before tuning baseline, as the reads depend on the ADC clock.
+// Returns 0, as refused, while the scanner runs: call it before CapADCScanner::begin().
+uint8_t CapADCPin::tunePrescaler(uint8_t minRatio){
+	return _adcChannel.calibratePrescaler(minRatio);
+}
 
 // Tune baseline.
 // Take an amount of readings and average them to get a new baseline value.
+// This blocks for length ms, use startTuneBaseline() to keep the loop running.
 void CapADCPin::tuneBaseline(uint32_t length){
-	uint32_t value = 0;
-	uint16_t count = 0;
-	length += millis();
-	while(length > millis()){
-		value += (uint32_t)updateRead();
-		++count;
-//		Serial.print("tuning...\t");
-//		Serial.println(i);
-//		Serial.println();
-	}
-
-	value /= count;
-	_baseline = value;
-	_read = _lastRead = _baseline;
+	startTuneBaseline(length);
+	while(isTuning()) update();
 }
 
 // Tune threshold.
 // Tune baseline, then read value from electrode for a given time, compute the max delta
-// and set threshold values for touch and prox.
+// and set threshold values for touch.
+// This blocks for about 1 + length / 1000 s, use startTuneThreshold() to keep the loop running.
 void CapADCPin::tuneThreshold(uint32_t length){
-	tuneBaseline();
-	length += millis();
-	uint16_t _minBaseline = _baseline;
-	uint16_t _maxBaseline = _baseline;
-	while(length > millis()){
-		uint16_t current = updateRead();
-		if(_minBaseline > current) _minBaseline = current;
-		if(_maxBaseline < current) _maxBaseline = current;
-
-	}
+	startTuneThreshold(length);
+	while(isTuning()) update();
+}
 
-	_maxDelta = _maxBaseline - _minBaseline;
-	uint16_t touch = (float)(_maxDelta * 0.4);
-	uint16_t release = (float)(touch * 0.6);
+// Start tuning baseline, without blocking.
+// Each call to update() then takes a reading for it, until length ms have passed.
+void CapADCPin::startTuneBaseline(uint32_t length){
+	startTune(length, 0);
+	_tuneSum = 0;
+	_tuneCount = 0;
+}
 
-	setTouchThreshold(touch);
-	setReleaseThreshold(release);
+// Start tuning baseline then threshold, without blocking.
+void CapADCPin::startTuneThreshold(uint32_t length){
+	startTune(1000, length);
+	_tuneSum = 0;
+	_tuneCount = 0;
 }
 
 // launch a new read sequence.
 int16_t CapADCPin::update(){
-	// Update reading, save previous one.
-	_lastRead = _read;
-//	uint32_t length = micros();
-//	Serial.println("u1");
-//	Serial.print('\t');
-	_read = updateRead();
-//	Serial.print(_read);
-//	Serial.print('\t');
-//	length = micros();
-	// Compute the exponential filter of reads.
-	// Less memory than a running average, and a bit faster to detect changes.
-//	float filter =  (float)_read * ((float)_gSettings.expWeight / 100) +
-//					(float)_lastRead * ((100 - (float)_gSettings.expWeight) / 100);
-	// Fix point math is faster than float numbers.
-	uint32_t filter = (uint32_t)_read * _gSettings.expWeight + 
-						(uint32_t)_lastRead * (255 - _gSettings.expWeight);
-	filter /= 0xff;
-	_read = filter;
-
-//	Serial.println(_read);
+	// While tuning, readings go to the tuning.
+	if(_tuneState != TuneIdle){
+		updateTune();
+		return 0;
+	}
+
+	uint32_t statsTime = statsStart();
+
+	// Update reading, and filter it.
+	uint16_t raw = updateRead();
+	_read = _filter.apply(raw);
 
 	// Compute the delta between read and baseline
 	_delta = (int16_t)_read - (int16_t)_baseline;
@@ -116,9 +125,13 @@ int16_t CapADCPin::update(){
 	_prev = _now;
 
 	// Prepare to touch
-	if(_delta > _lSettings.touchThreshold){
+	if(_delta > localTouchThreshold()){
 		_now = Touch;
 //		Serial.println("touch");
+	// Or prepare to prox, with hysteresis: once near, stay so down to the prox release threshold.
+	} else if(localProxThreshold() && ((_delta > localProxThreshold()) ||
+				((_prev == Prox || _prev == Touch) && (_delta > localProxReleaseThreshold())))){
+		_now = Prox;
 	// Or it's rising
 	} else if(_delta > 0){
 		_now = Rising;
@@ -133,16 +146,27 @@ int16_t CapADCPin::update(){
 //		Serial.println("idle");
 	}
 
-	if(_now != _prev) _lastTime = millis();
+	if(_now != _prev) _lastTime = CAP_ADC_MILLIS();
 
 	if(_now == Rising || _now == Falling) updateCal();
 
 	// Debounce the current instant state to see if we can use it to detect touch
-	if((_now == _prev) && ((millis() - _lastTime) > _gSettings.debounce)){
+	if((_now == _prev) && ((CAP_ADC_MILLIS() - _lastTime) > globalDebounce())){
 		_previousState = _state;
 		_state = _now;
+		if(_state != _previousState){
+			statsTransition();
+			eventTransition(_state, _previousState);
+		}
+	} else if(_now != _state){
+		statsDebounce();
 	}
 
+	eventLongPress();
+
+	statsUpdate(statsTime);
+	telemetry(0, _state, raw, _read, _baseline, _delta);
+
 	return _delta;
 }
 
@@ -164,6 +188,38 @@ bool CapADCPin::isJustReleased() const{
 	return false;
 }
 
+// Getter for prox state
+bool CapADCPin::isProx() const{
+	if(_state == Prox) return true;
+	return false;
+}
+
+// Getter for prox state
+bool CapADCPin::isJustProx() const{
+	if((_state == Prox) && (_previousState != Prox)) return true;
+	return false;
+}
+
+// Getter for prox state
+bool CapADCPin::isJustProxReleased() const{
+	if((_state != Prox) && (_previousState == Prox)) return true;
+	return false;
+}
+
+// How near the hand is, from 0 at the prox threshold to 255 at the touch one.
+// 0 when not in proximity, 255 when touched.
+uint8_t CapADCPin::proxRatio() const{
+	if(_state == Touch) return 0xff;
+	if(_state != Prox) return 0;
+
+	int16_t range = localTouchThreshold() - localProxThreshold();
+	int16_t step = _delta - localProxThreshold();
+	if(range <= 0 || step >= range) return 0xff;
+	if(step <= 0) return 0;
+
+	return ((uint32_t)step * 255) / range;
+}
+
 /*
 void CapADCPin::applyLocalSettings(const CapADCSetLocal_t& settings){
 	_lSettings = settings;
@@ -176,18 +232,111 @@ CapADCSetLocal_t CapADCPin::getLocalSettings() const{
 
 // Protected methods
 
+// Feed the running tuning with a new reading.
+void CapADCPin::updateTune(){
+	uint16_t current = updateRead();
+	uint32_t elapsed = tuneElapsed();
+
+	if(_tuneState == TuneBaseline){
+		_tuneSum += current;
+		++_tuneCount;
+
+		if(elapsed < _tuneBaselineLength) return;
+
+		// Baseline is the average of readings.
+		_baseline = _tuneSum / _tuneCount;
+		_read = _baseline;
+		_filter.reset(_baseline);
+
+		_tuneMin = _tuneMax = _baseline;
+		_tuneState = (_tuneThresholdLength != 0)?TuneThreshold:TuneIdle;
+
+	} else if(_tuneState == TuneThreshold){
+		if(_tuneMin > current) _tuneMin = current;
+		if(_tuneMax < current) _tuneMax = current;
+
+		if(elapsed < _tuneBaselineLength + _tuneThresholdLength) return;
+
+		// Thresholds are set from the noise amplitude: touch at 40%, release at 60% of touch.
+		_maxDelta = _tuneMax - _tuneMin;
+		uint16_t touch = ((uint32_t)_maxDelta * 2) / 5;
+		uint16_t release = ((uint32_t)touch * 3) / 5;
+
+		setTouchThreshold(touch);
+		setReleaseThreshold(release);
+
+		// Prox thresholds too, if used: prox at 4%, release at 70% of prox.
+		if(localProxThreshold()){
+			uint16_t prox = _maxDelta / 25;
+			if(prox == 0) prox = 1;
+			setProxThreshold(prox);
+			setProxReleaseThreshold(((uint32_t)prox * 7) / 10);
+		}
+
+		_tuneState = TuneIdle;
+	}
+}
+
+// A pin stores its single channel.
+uint8_t CapADCPin::getStoredCount() const{
+	return 1;
+}
+
+// Give the calibration of the channel to be stored.
+void CapADCPin::saveChannel(uint8_t index, CapADCStoredChannel_t& stored){
+	stored.baseline = _baseline;
+	stored.chargeDelay = _adcChannel.getChargeDelay();
+	stored.prescaler = _adcChannel.getPrescaler();
+	stored.resolution = _adcChannel.getResolution();
+}
+
+// Check a reading with the stored ADC settings is close enough to the stored baseline.
+// The current ADC settings are put back afterwards.
+// When attached to a scanner, restore once a first scan is complete.
+bool CapADCPin::checkChannel(uint8_t index, const CapADCStoredChannel_t& stored, uint16_t maxDrift){
+	uint8_t chargeDelay = _adcChannel.getChargeDelay();
+	uint8_t prescaler = _adcChannel.getPrescaler();
+	uint8_t resolution = _adcChannel.getResolution();
+
+	_adcChannel.setChargeDelay(stored.chargeDelay);
+	_adcChannel.setPrescaler(stored.prescaler);
+	_adcChannel.setResolution(stored.resolution);
+
+	uint16_t current = updateRead();
+	uint16_t drift = (current > stored.baseline)?(current - stored.baseline):(stored.baseline - current);
+
+	_adcChannel.setChargeDelay(chargeDelay);
+	_adcChannel.setPrescaler(prescaler);
+	_adcChannel.setResolution(resolution);
+
+	return drift <= maxDrift;
+}
+
+// Apply the stored calibration.
+void CapADCPin::restoreChannel(uint8_t index, const CapADCStoredChannel_t& stored){
+	_adcChannel.setChargeDelay(stored.chargeDelay);
+	_adcChannel.setPrescaler(stored.prescaler);
+	_adcChannel.setResolution(stored.resolution);
+
+	_baseline = stored.baseline;
+	_read = _baseline;
+	_filter.reset(_baseline);
+}
+
 // Update the baseline value
 void CapADCPin::updateCal(){
-	uint16_t timeDelta = millis() - _lastTime;
+	uint16_t timeDelta = CAP_ADC_MILLIS() - _lastTime;
 	if(_now == Rising){
-		if(timeDelta >= _gSettings.noiseCountRising){
-			_baseline += _gSettings.noiseIncrement;
-			_lastTime = millis();
+		if(timeDelta >= globalNoiseCountRising()){
+			_baseline += globalNoiseIncrement();
+			_lastTime = CAP_ADC_MILLIS();
+			statsBaseline();
 		}
 	} else if(_now == Falling){
-		if(timeDelta >= _gSettings.noiseCountFalling){
-			_baseline -= _gSettings.noiseIncrement;
-			_lastTime = millis();
+		if(timeDelta >= globalNoiseCountFalling()){
+			_baseline -= globalNoiseIncrement();
+			_lastTime = CAP_ADC_MILLIS();
+			statsBaseline();
 		}
 	}
 
@@ -195,19 +344,38 @@ void CapADCPin::updateCal(){
 
 // Get a serie of readings.
 uint16_t CapADCPin::updateRead(){
+	uint32_t statsTime = statsStart();
 	int32_t value = 0;
-	uint16_t samples = 1 << _gSettings.samples;
-	uint16_t divider = 1 << _gSettings.divider;
-
-	// One discarded read to account for errors on first read an a new ADC
-	_adcChannel->read();
+	uint16_t samples = 1 << globalSamples();
+	uint16_t conversions;
 
-	for(uint16_t i = 0; i < samples; ++i){
-		value += _adcChannel->read();
+	if(_scanIndex != CapADCScanner::NoIndex){
+		// The scanner already summed its slots for this channel.
+		value = CapADCScanner::getResult(_scanIndex);
+		conversions = CapADCScanner::getSlots(_scanIndex);
+	} else {
+		// One discarded read to account for errors on first read an a new ADC
+		_adcChannel.read();
+		conversions = samples + 1;
+
+		if(_adcChannel.getResolution() == 8 && globalSamples() <= 7){
+			// 8 bits reads can be summed on 16 bits, which is faster.
+			int16_t sum = 0;
+			for(uint16_t i = 0; i < samples; ++i){
+				sum += _adcChannel.read();
+			}
+			value = sum;
+		} else {
+			for(uint16_t i = 0; i < samples; ++i){
+				value += _adcChannel.read();
+			}
+		}
 	}
 
-	value /= divider;
+	// Divide by 2^divider, shifting is much faster than a 32 bits division.
+	value >>= globalDivider();
 
+	statsRead(statsTime, conversions);
 
 	return (uint16_t)value;
 }
@@ -26,15 +26,21 @@ class CapADCPin: public CapADC{
 public:
 
 	CapADCPin();
-	~CapADCPin();
 
 	void init(uint8_t pin, uint8_t friendPin = 0);
 
 	void setChargeDelay(uint8_t value);
+	void setResolution(uint8_t bits);
+	void setPrescaler(uint8_t value);
+	void setSleepRead(bool value);
 
+	bool attachScanner();
 
+	uint8_t tunePrescaler(uint8_t minRatio = 50);
 	void tuneBaseline(uint32_t length = 1000);
 	void tuneThreshold(uint32_t length = 5000);
+	void startTuneBaseline(uint32_t length = 1000);
+	void startTuneThreshold(uint32_t length = 5000);
 
 	int16_t update();
 
@@ -42,6 +48,11 @@ public:
 	bool isJustTouched() const;
 	bool isJustReleased() const;
 
+	bool isProx() const;
+	bool isJustProx() const;
+	bool isJustProxReleased() const;
+	uint8_t proxRatio() const;
+
 	uint16_t getBaseline() const{return _baseline;}
 	uint16_t getMaxDelta() const {return _maxDelta;}
 	int16_t getDelta() const {return _delta;}
@@ -52,9 +63,17 @@ public:
 protected:
 	uint16_t updateRead();
 	void updateCal();
+	void updateTune();
+
+	uint8_t getStoredCount() const;
+	void saveChannel(uint8_t index, CapADCStoredChannel_t& stored);
+	bool checkChannel(uint8_t index, const CapADCStoredChannel_t& stored, uint16_t maxDrift);
+	void restoreChannel(uint8_t index, const CapADCStoredChannel_t& stored);
 
 	// The pin linked to this capacitive channel;
-	CapADCChannel *_adcChannel;
+	CapADCChannel _adcChannel;
+	// Index of the channel in the scanner, if attached.
+	uint8_t _scanIndex;
 
 /*
 	// Local (pin) settings
@@ -62,14 +81,22 @@ protected:
 */
 	// values from readings
 	uint16_t _read;
-	uint16_t _lastRead;
 	int16_t _delta;
 
+	// Filter applied on readings
+	CapADCFilter _filter;
+
 	// Settings for filtering
 	uint16_t _baseline;
 	uint16_t _maxDelta;
 	uint32_t _lastTime;
 
+	// Values gathered while tuning
+	uint32_t _tuneSum;
+	uint32_t _tuneCount;
+	uint16_t _tuneMin;
+	uint16_t _tuneMax;
+
 	// States of sensing, instant and for reading
 	uint8_t _now;
 	uint8_t _prev;
@@ -0,0 +1,89 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAP_ADC_RING_H
+#define CAP_ADC_RING_H
+
+#include <Arduino.h>
+
+// Compiler barrier: memory accesses are not moved across it.
+// Enough on AVR, where there is no reordering by the CPU and one byte accesses are atomic.
+#ifndef CAP_ADC_BARRIER
+#define CAP_ADC_BARRIER()			__asm__ __volatile__("" ::: "memory")
+#endif
+
+// Single producer, single consumer ring buffer, to pass values from an interrupt to the loop
+// without disabling interrupts.
+// The producer only writes _head, the consumer only writes _tail. Both are 8 bits and free running,
+// so reading one of them is atomic, and the number of stored values is their difference.
+// Size is a power of two, up to 128.
+template<typename T, uint8_t Size>
+class CapADCRing{
+public:
+	CapADCRing():_head(0), _tail(0){}
+
+	// Producer side. Returns false if the buffer is full, the value is then dropped.
+	bool push(const T& value){
+		uint8_t head = _head;
+		if((uint8_t)(head - _tail) >= Size) return false;
+
+		_buffer[head & (Size - 1)] = value;
+		// The value must be stored before the consumer can see it.
+		CAP_ADC_BARRIER();
+		_head = head + 1;
+
+		return true;
+	}
+
+	// Consumer side. Returns false if the buffer is empty.
+	bool pop(T& value){
+		uint8_t tail = _tail;
+		if(tail == _head) return false;
+
+		value = _buffer[tail & (Size - 1)];
+		// The value must be read before the producer can write over it.
+		CAP_ADC_BARRIER();
+		_tail = tail + 1;
+
+		return true;
+	}
+
+	// Number of values stored. Exact from the consumer side, at least this from the producer side.
+	uint8_t available() const{
+		return _head - _tail;
+	}
+
+	bool isEmpty() const{
+		return _head == _tail;
+	}
+
+	// Drop all values. Only when the producer is stopped.
+	void clear(){
+		_tail = _head;
+	}
+
+protected:
+	static_assert(Size != 0 && Size <= 128 && (Size & (Size - 1)) == 0,
+					"CapADCRing size must be a power of two, up to 128");
+
+	T _buffer[Size];
+	volatile uint8_t _head;
+	volatile uint8_t _tail;
+};
+
+#endif
@@ -0,0 +1,311 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CapacitiveADCScanner.h"
+
+CapADCChannel *CapADCScanner::_channels[MAX_SCAN_CHANNEL];
+uint8_t CapADCScanner::_numChannels = 0;
+uint8_t CapADCScanner::_channelSlots[MAX_SCAN_CHANNEL];
+uint8_t CapADCScanner::_slots = 1;
+uint8_t CapADCScanner::_rounds = 1;
+uint32_t CapADCScanner::_period = 0;
+
+CapADCRing<CapADCSample_t, CAP_ADC_SCAN_RING_SIZE> CapADCScanner::_samples;
+volatile uint16_t CapADCScanner::_overruns = 0;
+
+int32_t CapADCScanner::_sum[MAX_SCAN_CHANNEL];
+uint8_t CapADCScanner::_reads[MAX_SCAN_CHANNEL];
+int32_t CapADCScanner::_result[MAX_SCAN_CHANNEL];
+uint8_t CapADCScanner::_published = 0;
+bool CapADCScanner::_complete = false;
+
+volatile uint8_t CapADCScanner::_current = 0;
+volatile uint8_t CapADCScanner::_slot = 0;
+
+volatile bool CapADCScanner::_running = false;
+volatile bool CapADCScanner::_paused = false;
+
+volatile uint32_t CapADCScanner::_scanCount = 0;
+volatile uint32_t CapADCScanner::_scanStart = 0;
+volatile uint32_t CapADCScanner::_scanTime = 0;
+
+void (*CapADCScanner::_onComplete)(void) = 0;
+
+// Public methods
+
+// Register a channel to be scanned. Returns its index in the scanner, or NoIndex if
+// the scanner is full or already running.
+uint8_t CapADCScanner::add(CapADCChannel *channel){
+	if(_running || _numChannels >= MAX_SCAN_CHANNEL) return NoIndex;
+
+	_channels[_numChannels] = channel;
+	_channelSlots[_numChannels] = 0;
+	_sum[_numChannels] = _result[_numChannels] = 0;
+	_reads[_numChannels] = 0;
+
+	return _numChannels++;
+}
+
+uint8_t CapADCScanner::getNumChannels(){
+	return _numChannels;
+}
+
+// Start scanning registered channels.
+// slots is the number of reads made on every scan for each channel not given its own by setSlots().
+// period is the time between the starts of two scans, in microseconds.
+// 0 scans continuously, as long as the loop keeps up.
+void CapADCScanner::begin(uint8_t slots, uint32_t period){
+	if(_running || _numChannels == 0) return;
+	if(slots == 0) slots = 1;
+
+	_slots = slots;
+	_period = period;
+	_rounds = 1;
+	for(uint8_t i = 0; i < _numChannels; ++i){
+		_sum[i] = 0;
+		_reads[i] = 0;
+		if(getSlots(i) > _rounds) _rounds = getSlots(i);
+	}
+	_published = 0;
+	_samples.clear();
+	_overruns = 0;
+	_scanCount = 0;
+	_scanTime = 0;
+	_current = _slot = 0;
+	_complete = false;
+	_paused = false;
+	_running = true;
+
+	// Wait for the ADC to be free, then take it with interrupts disabled,
+	// so that no other read completes with the scanner callback.
+	uint8_t oldSREG = SREG;
+	for(;;){
+		cli();
+		if(!CapADCChannel::isBusy()) break;
+		SREG = oldSREG;
+		CapADCChannel::service();
+		CAP_ADC_WAIT();
+	}
+	CapADCChannel::setDelayTimer(true);
+	CapADCChannel::setCallback(channelDone);
+	// The first scan starts now: its period is as good as elapsed.
+	_scanStart = CAP_ADC_MICROS() - period;
+	next();
+	_scanTime = 0;
+	SREG = oldSREG;
+}
+
+// Stop scanning. The read sequence in progress, if any, completes first.
+void CapADCScanner::end(){
+	if(!_running) return;
+
+	// A scan waiting for its period is not started anymore.
+	_running = false;
+	while(CapADCChannel::isBusy()){
+		CapADCChannel::service();
+		CAP_ADC_WAIT();
+	}
+	CapADCChannel::setCallback(0);
+	CapADCChannel::setDelayTimer(false);
+	_paused = false;
+}
+
+bool CapADCScanner::isRunning(){
+	return _running;
+}
+
+// Sum the reads handed by the interrupt since the last call, and resume the scanner if it stalled.
+// A channel is published each time it has its slots reads, the scan is complete when all are.
+// Called by isComplete() and getResult(), so there is no need to call it otherwise.
+void CapADCScanner::poll(){
+	CapADCSample_t sample;
+	while(_samples.pop(sample)){
+		uint8_t i = sample.index;
+		_sum[i] += sample.value;
+
+		if(++_reads[i] >= getSlots(i)){
+			_result[i] = _sum[i];
+			_sum[i] = 0;
+			_reads[i] = 0;
+
+			if(++_published >= _numChannels){
+				_published = 0;
+				_complete = true;
+				if(_onComplete) _onComplete();
+			}
+		}
+	}
+
+	// Nothing runs in the interrupt while paused: only the read started here can pause again.
+	if(_paused && _running){
+		_paused = false;
+		next();
+	}
+}
+
+// Number of times the scanner paused since begin() because the ring was full:
+// the loop didn't poll fast enough, and the scans were slowed down.
+uint16_t CapADCScanner::getOverruns(){
+	uint8_t oldSREG = SREG;
+	cli();
+	uint16_t value = _overruns;
+	SREG = oldSREG;
+
+	return value;
+}
+
+// Tells if a new scan has been published since the last call.
+bool CapADCScanner::isComplete(){
+	poll();
+	if(!_complete) return false;
+	_complete = false;
+	return true;
+}
+
+// Get the sum of the reads of a channel for the last scan.
+int32_t CapADCScanner::getResult(uint8_t index){
+	if(index >= _numChannels) return 0;
+
+	poll();
+	return _result[index];
+}
+
+// Set the number of reads made on every scan for a channel, by its index from add().
+// 0 goes back to the number given to begin(). Refused while the scanner runs.
+// A sensor attached to the channel gets the sum of these reads, so its thresholds need tuning again.
+bool CapADCScanner::setSlots(uint8_t index, uint8_t slots){
+	if(_running || index >= _numChannels) return false;
+
+	_channelSlots[index] = slots;
+	return true;
+}
+
+// Number of reads made for a channel on every scan.
+uint8_t CapADCScanner::getSlots(uint8_t index){
+	if(index >= _numChannels) return 0;
+
+	uint8_t slots = _channelSlots[index];
+	return (slots != 0)?slots:_slots;
+}
+
+// Number of scans completed since the scanner started.
+uint32_t CapADCScanner::getScanCount(){
+	uint8_t oldSREG = SREG;
+	cli();
+	uint32_t value = _scanCount;
+	SREG = oldSREG;
+
+	return value;
+}
+
+// Time between the starts of the last two scans, in microseconds, pauses included.
+uint32_t CapADCScanner::getScanTime(){
+	uint8_t oldSREG = SREG;
+	cli();
+	uint32_t value = _scanTime;
+	SREG = oldSREG;
+
+	return value;
+}
+
+// Number of complete scans per second, computed from the last scan time.
+uint16_t CapADCScanner::getScanRate(){
+	uint32_t time = getScanTime();
+	if(time == 0) return 0;
+
+	return 1000000UL / time;
+}
+
+// Set a function to be called each time a scan is published.
+// It is called from poll(), in the loop.
+void CapADCScanner::onComplete(void (*callback)(void)){
+	_onComplete = callback;
+}
+
+// Protected methods
+
+// Called from the ADC interrupt each time a channel is done.
+// Hand its value to the loop, then launch the next read of the pipeline.
+void CapADCScanner::channelDone(CapADCChannel *channel){
+	CapADCSample_t sample = {_current, channel->getValue()};
+	if(!_samples.push(sample)) ++_overruns;
+
+	advance();
+	if(_running) next();
+}
+
+// Called from the delay timer interrupt, while waiting for the scan period.
+void CapADCScanner::periodElapsed(){
+	if(_running) next();
+}
+
+// Move to the next read: the next channel with slots left in this round,
+// else the first of the next round, else the first of the next scan.
+void CapADCScanner::advance(){
+	uint8_t current = _current;
+	uint8_t slot = _slot;
+
+	for(;;){
+		if(++current >= _numChannels){
+			current = 0;
+			if(++slot >= _rounds){
+				slot = 0;
+				++_scanCount;
+			}
+		}
+		if(getSlots(current) > slot) break;
+	}
+
+	_current = current;
+	_slot = slot;
+}
+
+// Launch the next read of the pipeline.
+// When the ring is full, the scanner stalls until poll() drains it.
+// When a scan would start before the period is elapsed, the delay timer wakes it up later,
+// or without delay timer, poll() does.
+// From the interrupts, from begin(), or from poll() while paused.
+void CapADCScanner::next(){
+	if(_samples.available() >= CAP_ADC_SCAN_RING_SIZE){
+		++_overruns;
+		_paused = true;
+		return;
+	}
+
+	bool scan = (_current == 0) && (_slot == 0);
+	uint32_t now = 0;
+	if(scan){
+		now = CAP_ADC_MICROS();
+		uint32_t elapsed = now - _scanStart;
+		if(elapsed < _period){
+			if(!CapADCChannel::wakeAfter(_period - elapsed, periodElapsed)) _paused = true;
+			return;
+		}
+	}
+
+	if(!_channels[_current]->start()){
+		_paused = true;
+		return;
+	}
+
+	// A new scan: time the last one.
+	if(scan){
+		_scanTime = now - _scanStart;
+		_scanStart = now;
+	}
+}
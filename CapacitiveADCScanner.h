@@ -0,0 +1,122 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAP_ADC_SCANNER_H
+#define CAP_ADC_SCANNER_H
+
+#define MAX_SCAN_CHANNEL		16
+
+// Number of reads the interrupt can hand to the loop before they are dropped.
+// A power of two, up to 128.
+#ifndef CAP_ADC_SCAN_RING_SIZE
+#define CAP_ADC_SCAN_RING_SIZE	32
+#endif
+
+#include <Arduino.h>
+#include "CapacitiveADCChannel.h"
+#include "CapacitiveADCRing.h"
+
+// One read, handed from the interrupt to the loop.
+struct CapADCSample_t{
+	uint8_t index;
+	int16_t value;
+};
+
+// The scanner owns a list of channels, and chains their read sequences from the ADC interrupt,
+// one channel after another, so all registered electrodes are read in a single pipeline.
+// Each channel is read slots times per scan, in rounds: a round reads once every channel
+// that still has slots to read, so a scan lasts as many rounds as the most read channel.
+// The interrupt pushes each read to a ring buffer. poll(), called by isComplete() and getResult(),
+// drains it in the loop and publishes the sum of a channel each time it has its slots reads,
+// so neither side ever disables interrupts to share them.
+// The charge transfers are timed by the delay timer, so the interrupts stay short.
+// Between scans, the delay timer also waits for the scan period, and starts the next scan
+// from its interrupt: scans don't depend on the loop.
+// The pipeline only stalls when the ring is full, until poll() drains it:
+// no read is ever dropped, and a loop too slow to keep up slows the scans down.
+// Without delay timer (CAP_ADC_DELAY_TIMER 0), poll() starts the scans after the period too.
+// While the scanner runs, the ADC is its own: read() and calibratePrescaler() on any channel refuse.
+class CapADCScanner{
+public:
+
+	static const uint8_t NoIndex = 0xff;
+
+	static uint8_t add(CapADCChannel *channel);
+	static uint8_t getNumChannels();
+
+	static void begin(uint8_t slots = 1, uint32_t period = 0);
+	static void end();
+	static bool isRunning();
+
+	static void poll();
+	static uint16_t getOverruns();
+
+	static bool isComplete();
+	static int32_t getResult(uint8_t index);
+
+	static bool setSlots(uint8_t index, uint8_t slots);
+	static uint8_t getSlots(uint8_t index);
+	static uint32_t getScanCount();
+	static uint32_t getScanTime();
+	static uint16_t getScanRate();
+
+	static void onComplete(void (*callback)(void));
+
+protected:
+	static void channelDone(CapADCChannel *channel);
+	static void periodElapsed();
+	static void next();
+	static void advance();
+
+	static CapADCChannel *_channels[MAX_SCAN_CHANNEL];
+	static uint8_t _numChannels;
+	// Reads per scan of each channel, 0 for the default given to begin().
+	static uint8_t _channelSlots[MAX_SCAN_CHANNEL];
+	static uint8_t _slots;
+	// Rounds per scan: the most slots of a channel.
+	static uint8_t _rounds;
+	static uint32_t _period;
+
+	// Reads from the interrupt, not summed yet.
+	static CapADCRing<CapADCSample_t, CAP_ADC_SCAN_RING_SIZE> _samples;
+	static volatile uint16_t _overruns;
+
+	// Reads being summed, their number, and published sums from the last scan. Loop side only.
+	static int32_t _sum[MAX_SCAN_CHANNEL];
+	static uint8_t _reads[MAX_SCAN_CHANNEL];
+	static int32_t _result[MAX_SCAN_CHANNEL];
+	// Channels published for the scan being summed.
+	static uint8_t _published;
+	static bool _complete;
+
+	// Position in the current scan.
+	static volatile uint8_t _current;
+	static volatile uint8_t _slot;
+
+	static volatile bool _running;
+	// Waiting for the loop to poll: the ring is full, or the period is not elapsed without delay timer.
+	static volatile bool _paused;
+
+	static volatile uint32_t _scanCount;
+	static volatile uint32_t _scanStart;
+	static volatile uint32_t _scanTime;
+
+	static void (*_onComplete)(void);
+};
+
+#endif
@@ -21,366 +21,468 @@
 // Public methods
 
 // Constructor
-CapADCSlider::CapADCSlider(){
-	for(uint8_t i = 0; i <= MAX_SLIDER_CHANNEL; ++i){
-		_nowState[i] = _prevState[i] = _state[i] = _previousState[i] = Idle;
-		_lastTime[i] = millis();
-		_numChannels = 0;
-	}
-
-	_lSettings.resetCounter = 60;
+// Channels and segments are owned by the derived class, that gives them here.
+CapADCSliderBase::CapADCSliderBase(CapADCChannel *channels, CapADCSegment_t *segments,
+									const int8_t *weighting, uint8_t numChannels){
+	_adcChannel = channels;
+	_segment = segments;
+	_weighting = weighting;
+	_numChannels = numChannels;
+
+	_scanIndex = CapADCScanner::NoIndex;
+	_resetCounter = 60;
 	_position = _prevPosition = _nowPosition = _step = 0;
-	_coeff = 32;
 }
 
-// Destructor
-CapADCSlider::~CapADCSlider(){
+// Init the object. Tie it to used pins.
+// Each channel uses the next one as friend pin, the last one uses the first.
+void CapADCSliderBase::initChannels(const uint8_t *pins){
 	for(uint8_t i = 0; i < _numChannels; ++i){
-		delete _adcChannel[i];
+		uint8_t next = (i + 1 < _numChannels)?(i + 1):0;
+		_adcChannel[i].init(pins[i], pins[next]);
 	}
 }
 
-// Init the object. Tie it to used pins.
-
-void CapADCSlider::init(uint8_t pin0, uint8_t pin1){
-	if(_numChannels != 0) return;
-	_adcChannel[0] = new CapADCChannel();
-	_adcChannel[0]->init(pin0, pin1);
-	_adcChannel[1] = new CapADCChannel();
-	_adcChannel[1]->init(pin1, pin0);
-
-	_numChannels = 2;
-
-	_weighting[0] = 127;
-	_weighting[1] = -127;	
+// change the charge delay for this channel
+void CapADCSliderBase::setChargeDelay(uint8_t value){
+	for(uint8_t i = 0; i < _numChannels; ++i){
+		_adcChannel[i].setChargeDelay(value);
+	}
 }
 
-void CapADCSlider::init(uint8_t pin0, uint8_t pin1, uint8_t pin2){
-	if(_numChannels != 0) return;
-
-	_adcChannel[0] = new CapADCChannel();
-	_adcChannel[0]->init(pin0, pin1);
-	_adcChannel[1] = new CapADCChannel();
-	_adcChannel[1]->init(pin1, pin2);
-	_adcChannel[2] = new CapADCChannel();
-	_adcChannel[2]->init(pin2, pin0);
-
-	_numChannels = 3;
-
-	_weighting[0] = 127;
-	_weighting[1] = 0;	
-	_weighting[2] = -127;	
+// Change the resolution (8 or 10 bits) for all channels.
+void CapADCSliderBase::setResolution(uint8_t bits){
+	for(uint8_t i = 0; i < _numChannels; ++i){
+		_adcChannel[i].setResolution(bits);
+	}
 }
 
-void CapADCSlider::init(uint8_t pin0, uint8_t pin1, uint8_t pin2, uint8_t pin3){
-	if(_numChannels != 0) return;
-
-	_adcChannel[0] = new CapADCChannel();
-	_adcChannel[0]->init(pin0, pin1);
-	_adcChannel[1] = new CapADCChannel();
-	_adcChannel[1]->init(pin1, pin2);
-	_adcChannel[2] = new CapADCChannel();
-	_adcChannel[2]->init(pin2, pin3);
-	_adcChannel[3] = new CapADCChannel();
-	_adcChannel[3]->init(pin3, pin0);
-
-	_numChannels = 4;
-
-	_weighting[0] = 127;
-	_weighting[1] = 42;	
-	_weighting[2] = -42;	
-	_weighting[3] = -127;	
-
+// Change the ADC prescaler for all channels.
+void CapADCSliderBase::setPrescaler(uint8_t value){
+	for(uint8_t i = 0; i < _numChannels; ++i){
+		_adcChannel[i].setPrescaler(value);
+	}
 }
 
-/*
-// If ever you need more channels for one long slider, you can uncomment this init function.
-// You will have to uncomment also the matching one in CapADCSlider.h,
-// and also change the #define MAX_SLIDER_CHANNEL accordingly.
-// If you ever need even more than 6 channels (wich is unlikely to happen if you use a Uno),
-// just copy the body of the function, and add lines for other channels. ;)
-
-void CapADCSlider::init(uint8_t pin0, uint8_t pin1, uint8_t pin2, uint8_t pin3, uint8_t pin4){
-	if(_numChannels != 0) return;
-
-	_adcChannel[0] = new CapADCChannel();
-	_adcChannel[0]->init(pin0, pin1);
-	_adcChannel[1] = new CapADCChannel();
-	_adcChannel[1]->init(pin1, pin2);
-	_adcChannel[2] = new CapADCChannel();
-	_adcChannel[2]->init(pin2, pin3);
-	_adcChannel[3] = new CapADCChannel();
-	_adcChannel[3]->init(pin3, pin4);
-	_adcChannel[4] = new CapADCChannel();
-	_adcChannel[4]->init(pin4, pin0);
-
-	_numChannels = 5;
-
-	_weighting[0] = 127;
-	_weighting[1] = 32;	
-	_weighting[2] = 0;	
-	_weighting[3] = -32;	
-	_weighting[4] = -127;	
-
+// Read in ADC noise reduction sleep mode.
+void CapADCSliderBase::setSleepRead(bool value){
+	for(uint8_t i = 0; i < _numChannels; ++i){
+		_adcChannel[i].setSleepRead(value);
+	}
 }
 
-void CapADCSlider::init(uint8_t pin0, uint8_t pin1, uint8_t pin2, uint8_t pin3, uint8_t pin4, uint8_t pin5){
-	if(_numChannels != 0) return;
-
-	_adcChannel[0] = new CapADCChannel();
-	_adcChannel[0]->init(pin0, pin1);
-	_adcChannel[1] = new CapADCChannel();
-	_adcChannel[1]->init(pin1, pin2);
-	_adcChannel[2] = new CapADCChannel();
-	_adcChannel[2]->init(pin2, pin3);
-	_adcChannel[3] = new CapADCChannel();
-	_adcChannel[3]->init(pin3, pin4);
-	_adcChannel[4] = new CapADCChannel();
-	_adcChannel[4]->init(pin4, pin5);
-	_adcChannel[5] = new CapADCChannel();
-	_adcChannel[5]->init(pin5, pin0);
-
-	_numChannels = 6;
-
-	_weighting[0] = 127;
-	_weighting[1] = 77;	
-	_weighting[2] = 27;	
-	_weighting[3] = -27;
-	_weighting[4] = -77;	
-	_weighting[5] = -127;	
+// Register all the channels to the scanner, consecutively.
+// Reads are then taken from the last scan. Call before CapADCScanner::begin().
+bool CapADCSliderBase::attachScanner(void){
+	if(_scanIndex != CapADCScanner::NoIndex) return true;
+	if(_numChannels == 0) return false;
+	if(CapADCScanner::getNumChannels() + _numChannels > MAX_SCAN_CHANNEL) return false;
 
+	_scanIndex = CapADCScanner::add(&_adcChannel[0]);
+	for(uint8_t i = 1; i < _numChannels; ++i){
+		CapADCScanner::add(&_adcChannel[i]);
+	}
+
+	return _scanIndex != CapADCScanner::NoIndex;
 }
-*/
 
-// change the charge delay for this channel
-void CapADCSlider::setChargeDelay(uint8_t value){
+// Tune prescaler.
+// Each channel gets the fastest ADC clock for which its signal is at least minRatio times its noise.
+// Returns the slowest prescaler selected. Do it before tuning baseline.
+// Returns 0, as refused, while the scanner runs: call it before CapADCScanner::begin().
+uint8_t CapADCSliderBase::tunePrescaler(uint8_t minRatio){
+	uint8_t slowest = 0;
 	for(uint8_t i = 0; i < _numChannels; ++i){
-		_adcChannel[i]->setChargeDelay(value);
+		uint8_t prescaler = _adcChannel[i].calibratePrescaler(minRatio);
+		if(prescaler == 0) return 0;
+		if(prescaler > slowest) slowest = prescaler;
 	}
+
+	return slowest;
 }
 
 // Tune baseline.
 // Take an amount of readings and average them to get a new baseline value.
-void CapADCSlider::tuneBaseline(uint32_t length){
-	_baseline[_numChannels] = 0;
-
-	for(uint8_t i = 0; i < _numChannels; ++i){
-		uint32_t value = 0;
-		uint16_t count = 0;
-		uint32_t len = millis() + length;
-		while(len > millis()){
-			value += (uint32_t)updateRead(i);
-			++count;
-		}
-
-		value /= count;
-		_baseline[i] = value;
-		_baseline[_numChannels] += value;
-//		_minBaseline = _maxBaseline = _baseline;
-		_currentRead[i] = _previousRead[i] = _baseline[i];
-	}
-
-	_baseline[_numChannels] /= _numChannels;
-	_currentRead[_numChannels] = _previousRead[_numChannels] = _baseline[_numChannels];
-
-
+// All channels are read in turn, so this blocks for length ms whatever the number of channels.
+// Use startTuneBaseline() to keep the loop running.
+void CapADCSliderBase::tuneBaseline(uint32_t length){
+	startTuneBaseline(length);
+	while(isTuning()) update();
 }
 
 // Tune threshold.
-// Tune baseline, then read value from electrode for a given time, compute the max delta
+// Tune baseline, then read value from electrodes for a given time, compute the max delta
 // and set threshold values for touch.
-void CapADCSlider::tuneThreshold(uint32_t length){
-	tuneBaseline();
-	length += millis();
-	uint16_t minBaseline[_numChannels];
-	uint16_t maxBaseline[_numChannels];
-	while(length > millis()){
-		for(uint8_t i = 0; i < _numChannels; ++i){
-			uint16_t current = updateRead(0);
-			if(minBaseline[i] > current) minBaseline[i] = current;
-			if(maxBaseline[i] < current) maxBaseline[i] = current;
-		}
-
-	}
-
-	uint16_t delta = 0;
-	for(uint8_t i = 0; i < _numChannels; ++i){
-		delta += maxBaseline[i] - minBaseline[i];
-	}
-
-	delta /= _numChannels;
+// This blocks, use startTuneThreshold() to keep the loop running.
+void CapADCSliderBase::tuneThreshold(uint32_t length){
+	startTuneThreshold(length);
+	while(isTuning()) update();
+}
 
-	uint16_t touch = (float)(delta * 0.4);
-	uint16_t release = (float)(touch * 0.6);
+// Start tuning baseline, without blocking.
+// Each call to update() then takes a reading of every channel for it, until length ms have passed.
+void CapADCSliderBase::startTuneBaseline(uint32_t length){
+	startTune(length, 0);
+	resetTune();
+}
 
-	setTouchThreshold(touch);
-	setReleaseThreshold(release);
+// Start tuning baseline then threshold, without blocking.
+void CapADCSliderBase::startTuneThreshold(uint32_t length){
+	startTune(200, length);
+	resetTune();
 }
 
 // launch a new read sequence.
-int16_t CapADCSlider::update(void){
+int16_t CapADCSliderBase::update(void){
+	// While tuning, readings go to the tuning.
+	if(_tuneState != TuneIdle){
+		updateTune();
+		return 0;
+	}
 
-	// We first update the last virtual channel, which is the average of all others
-	_previousRead[_numChannels] = _currentRead[_numChannels];
-	// And set the current read to 0, so we can add to it on each reading.
-	_currentRead[_numChannels] = 0;
+	uint32_t statsTime = statsStart();
+
+	// The last virtual channel is the average of all others.
+	// We set its current read to 0, so we can add to it on each reading.
+	_segment[_numChannels].currentRead = 0;
 
 	for(uint8_t i = 0; i <= _numChannels; ++i){
 		if(i < _numChannels){
 			// For each "real" channel, we update the reading
-			_previousRead[i] = _currentRead[i];
-			_currentRead[i] = updateRead(i);
+			_segment[i].currentRead = updateRead(i);
 			// And ad it to the virtual global channel
-			_currentRead[_numChannels] += _currentRead[i];
+			_segment[_numChannels].currentRead += _segment[i].currentRead;
 		} else {
 			// If we are processing the global channel, we finish compute average.
-			_currentRead[i] /= _numChannels;
+			_segment[i].currentRead /= _numChannels;
 		}
 
-		// We compute the exponential filter for this channel
-		// This take the last value of a channel, and ponderate it with the new one.
-		// It has about the same effect than a running average, but uses much less memory!
-		uint32_t filter = (uint32_t)_currentRead[i] * _gSettings.expWeight + 
-						(uint32_t)_previousRead[i] * (255 - _gSettings.expWeight);
-		filter /= 0xff;
-		// Store the new filter value in place of the reading.
-		_currentRead[i] = filter;
+		// We filter this channel, and store the new filter value in place of the reading.
+		uint16_t raw = _segment[i].currentRead;
+		_segment[i].currentRead = _segment[i].filter.apply(raw);
 
 		// We compute the delta between current read and baseline
-		_delta[i] = _currentRead[i] - _baseline[i];
+		_segment[i].delta = _segment[i].currentRead - _segment[i].baseline;
 		// Update current state
-		_prevState[i] = _nowState[i];
+		_segment[i].prevState = _segment[i].nowState;
 
 		// And act accordingly.
 		// Update baseline
-		if(_delta[i] > _lSettings.touchThreshold){
-			_nowState[i] = Touch;
+		if(_segment[i].delta > localTouchThreshold()){
+			_segment[i].nowState = Touch;
 		// Or it's rising
-		} else if(_delta[i] > 0){
-			_nowState[i] = Rising;
+		} else if(_segment[i].delta > 0){
+			_segment[i].nowState = Rising;
 		// Or it's falling
-		} else if(_delta[i] < 0){
-			_nowState[i] = Falling;
+		} else if(_segment[i].delta < 0){
+			_segment[i].nowState = Falling;
 		// Or nothing.
 		} else {
-			_nowState[i] = Idle;
+			_segment[i].nowState = Idle;
 		}
 
 		// If the state has changed, we reset counter (for baseline updating),
 		// and keep track of current time, for debouncing.
-		if(_nowState[i] != _prevState[i]){
-			_lastTime[i] = millis();
+		if(_segment[i].nowState != _segment[i].prevState){
+			_segment[i].lastTime = CAP_ADC_MILLIS();
 		}
 
 		// If we are on a real channel, we may have to update baseline.
-		if((_nowState[i] == Rising || _nowState[i] == Falling) && i != _numChannels){
+		if((_segment[i].nowState == Rising || _segment[i].nowState == Falling) && i != _numChannels){
 			updateCal(i);
 		}
 
 		// Debounce the current instant state to see if we can use it to detect touch
-		if((_nowState[i] == _prevState[i]) && ((millis() - _lastTime[i]) > _gSettings.debounce)){
-			_previousState[i] = _state[i];
-			_state[i] = _nowState[i];
+		if((_segment[i].nowState == _segment[i].prevState) && ((CAP_ADC_MILLIS() - _segment[i].lastTime) > globalDebounce())){
+			_segment[i].previousState = _segment[i].state;
+			_segment[i].state = _segment[i].nowState;
+			if(_segment[i].state != _segment[i].previousState){
+				statsTransition();
+				// The virtual channel tells if the slider is touched.
+				if(i == _numChannels) eventTransition(_segment[i].state, _segment[i].previousState);
+			}
+		} else if(_segment[i].nowState != _segment[i].state){
+			statsDebounce();
 		}
+
+		telemetry(i, _segment[i].state, raw, _segment[i].currentRead, _segment[i].baseline, _segment[i].delta);
 	}
 
-	return updatePosition();
+	eventLongPress();
+
+	// The move is the one added to the step.
+	int8_t step = _step;
+	bool touch = updatePosition();
+	if(touch && _step != step) eventSlide(_step - step);
+
+	statsUpdate(statsTime);
+
+	return touch;
 }
 
 // Getter for touch state
-bool CapADCSlider::isTouched(void) const{
-	if(_state[_numChannels] == Touch) return true;
+bool CapADCSliderBase::isTouched(void) const{
+	if(_segment[_numChannels].state == Touch) return true;
 	return false;
 }
 
+// Tells if getPosition() is the one of the current touch.
+// It is only updated from the second touched update on: the first one has no previous position.
+bool CapADCSliderBase::hasPosition(void) const{
+	const CapADCSegment_t &segment = _segment[_numChannels];
+	return (segment.state == Touch) && (segment.previousState == Touch);
+}
+
 // Getter for current value
-int8_t CapADCSlider::getPosition(void) const{
+int8_t CapADCSliderBase::getPosition(void) const{
+	return _position >> 8;
+}
+
+// Getter for current value, with 8 more bits of resolution.
+// From 32512 on the first channel to -32512 on the last one, getPosition() being its high byte.
+// On a wheel it is an angle, a full turn being 65536.
+int16_t CapADCSliderBase::getPosition16(void) const{
 	return _position;
 }
 
 // Getter for current step value.
 // We reset the _step value, so we can keep track of missed movement.
-int8_t CapADCSlider::getStep(void){
+int8_t CapADCSliderBase::getStep(void){
 	int8_t step = _step;
 	_step = 0;
 	return step;
 }
 
 
-uint16_t CapADCSlider::getBaseline(void) const{
-	return _baseline[_numChannels];
+uint16_t CapADCSliderBase::getBaseline(void) const{
+	return _segment[_numChannels].baseline;
 }
 
 // Protected methods
 
 // Compute current position
-bool CapADCSlider::updatePosition(void){
+bool CapADCSliderBase::updatePosition(void){
 
 	bool touch = false;
 	// If we have a touch, it's time to see where on the slider we are!
-	if(_state[_numChannels] == Touch){
+	if(_segment[_numChannels].state == Touch){
 		// Keep a track for the last position
 		_prevPosition = _nowPosition;
 
+		// The position is the barycentre of channel weights, by their deltas.
+		// Weighted deltas are summed first, so there is only one division by the total, whatever the size.
 		int32_t bary = 0;
-		// Compute, for each channel, its ponderate delta / average, then weight it.
+		int32_t sum = 0;
 		for(uint8_t i = 0; i < _numChannels; ++i){
+			int16_t delta = _segment[i].delta;
+			if(delta <= 0) continue;
+			bary += (int32_t)_weighting[i] * delta;
+			sum += delta;
+		}
 
-			int32_t bary0 = _coeff * (int32_t)_delta[i];
-			bary0 /= _delta[_numChannels];
-			bary += _weighting[i] * bary0;
+		// Keep the total on 16 bits, so the barycentre with 8 bits of fraction fits 32 bits.
+		while(sum > 0xFFFF){
+			sum >>= 1;
+			bary >>= 1;
 		}
 
-		_nowPosition = bary / 64;
+		if(sum > 0){
+			_nowPosition = (bary * 256) / sum;
+		}
 
 		// If we have two or more consecutive Touch states, we can update position and step
 		// (we don't update on the first read state to avoid absurd step values)
-		if(_previousState[_numChannels == Touch]){
+		if(_segment[_numChannels].previousState == Touch){
 			touch = true;
 			_position = _nowPosition;
-			_step += _position - _prevPosition;		
+			_step += (_position >> 8) - (_prevPosition >> 8);
 		}
 	}
 
 	return touch;
 }
 
+// Feed the running tuning with new readings.
+void CapADCSliderBase::updateTune(void){
+	uint32_t elapsed = tuneElapsed();
+
+	if(_tuneState == TuneBaseline){
+		// Channels are sampled in turn, so they are all averaged over the same time window.
+		for(uint8_t i = 0; i < _numChannels; ++i){
+			_segment[i].tuneSum += updateRead(i);
+			++_segment[i].tuneCount;
+		}
+
+		if(elapsed < _tuneBaselineLength) return;
+
+		endTuneBaseline();
+		_tuneState = (_tuneThresholdLength != 0)?TuneThreshold:TuneIdle;
+
+	} else if(_tuneState == TuneThreshold){
+		for(uint8_t i = 0; i < _numChannels; ++i){
+			uint16_t current = updateRead(i);
+			if(_segment[i].tuneMin > current) _segment[i].tuneMin = current;
+			if(_segment[i].tuneMax < current) _segment[i].tuneMax = current;
+		}
+
+		if(elapsed < _tuneBaselineLength + _tuneThresholdLength) return;
+
+		// Thresholds are set from the average noise amplitude: touch at 40%, release at 60% of touch.
+		uint32_t delta = 0;
+		for(uint8_t i = 0; i < _numChannels; ++i){
+			delta += _segment[i].tuneMax - _segment[i].tuneMin;
+		}
+
+		delta /= _numChannels;
+
+		uint16_t touch = (delta * 2) / 5;
+		uint16_t release = ((uint32_t)touch * 3) / 5;
+
+		setTouchThreshold(touch);
+		setReleaseThreshold(release);
+
+		_tuneState = TuneIdle;
+	}
+}
+
+// Clear the values gathered by a previous tuning.
+void CapADCSliderBase::resetTune(void){
+	for(uint8_t i = 0; i < _numChannels; ++i){
+		_segment[i].tuneSum = 0;
+		_segment[i].tuneCount = 0;
+	}
+}
+
+// Set each channel baseline to the mean of its readings.
+void CapADCSliderBase::endTuneBaseline(void){
+	for(uint8_t i = 0; i < _numChannels; ++i){
+		if(_segment[i].tuneCount != 0){
+			_segment[i].baseline = _segment[i].tuneSum / _segment[i].tuneCount;
+		}
+	}
+
+	resetBaselines();
+}
+
+// Compute the baseline of the virtual channel, and reset readings and filters to the baselines.
+void CapADCSliderBase::resetBaselines(void){
+	uint32_t global = 0;
+
+	for(uint8_t i = 0; i <= _numChannels; ++i){
+		if(i < _numChannels){
+			global += _segment[i].baseline;
+		} else {
+			_segment[i].baseline = global / _numChannels;
+		}
+
+		_segment[i].currentRead = _segment[i].baseline;
+		_segment[i].filter.reset(_segment[i].baseline);
+		_segment[i].tuneMin = _segment[i].tuneMax = _segment[i].baseline;
+	}
+}
+
+// Number of channels stored by saveCalibration().
+uint8_t CapADCSliderBase::getStoredCount(void) const{
+	return _numChannels;
+}
+
+// Give the calibration of a channel to be stored.
+void CapADCSliderBase::saveChannel(uint8_t index, CapADCStoredChannel_t& stored){
+	stored.baseline = _segment[index].baseline;
+	stored.chargeDelay = _adcChannel[index].getChargeDelay();
+	stored.prescaler = _adcChannel[index].getPrescaler();
+	stored.resolution = _adcChannel[index].getResolution();
+}
+
+// Check a reading of a channel with its stored ADC settings is close enough to its stored baseline.
+// The current ADC settings are put back afterwards.
+bool CapADCSliderBase::checkChannel(uint8_t index, const CapADCStoredChannel_t& stored, uint16_t maxDrift){
+	CapADCChannel &channel = _adcChannel[index];
+	uint8_t chargeDelay = channel.getChargeDelay();
+	uint8_t prescaler = channel.getPrescaler();
+	uint8_t resolution = channel.getResolution();
+
+	channel.setChargeDelay(stored.chargeDelay);
+	channel.setPrescaler(stored.prescaler);
+	channel.setResolution(stored.resolution);
+
+	uint16_t current = updateRead(index);
+	uint16_t drift = (current > stored.baseline)?(current - stored.baseline):(stored.baseline - current);
+
+	channel.setChargeDelay(chargeDelay);
+	channel.setPrescaler(prescaler);
+	channel.setResolution(resolution);
+
+	return drift <= maxDrift;
+}
+
+// Apply the stored calibration of a channel.
+// The virtual channel is computed again once the last channel is restored.
+void CapADCSliderBase::restoreChannel(uint8_t index, const CapADCStoredChannel_t& stored){
+	_adcChannel[index].setChargeDelay(stored.chargeDelay);
+	_adcChannel[index].setPrescaler(stored.prescaler);
+	_adcChannel[index].setResolution(stored.resolution);
+
+	_segment[index].baseline = stored.baseline;
+	if(index == _numChannels - 1) resetBaselines();
+}
+
 // Update the baseline value
-void CapADCSlider::updateCal(uint8_t index){
+void CapADCSliderBase::updateCal(uint8_t index){
 	// We check the time delta since last update
-	uint16_t timeDelta = millis() - _lastTime[index];
+	uint16_t timeDelta = CAP_ADC_MILLIS() - _segment[index].lastTime;
 	// Then if above noise count threshold, we update baseline, rising or falling.
-	if(_nowState[index] == Rising){
-		if(timeDelta >= _gSettings.noiseCountRising){
-			_baseline[index] += _gSettings.noiseIncrement;
-			_lastTime[index] = millis();
+	if(_segment[index].nowState == Rising){
+		if(timeDelta >= globalNoiseCountRising()){
+			_segment[index].baseline += globalNoiseIncrement();
+			_segment[index].lastTime = CAP_ADC_MILLIS();
+			statsBaseline();
 		}
-	} else if(_nowState[index] == Falling){
-		if(timeDelta >= _gSettings.noiseCountFalling){
-			_baseline[index] -= _gSettings.noiseIncrement;
-			_lastTime[index] = millis();
+	} else if(_segment[index].nowState == Falling){
+		if(timeDelta >= globalNoiseCountFalling()){
+			_segment[index].baseline -= globalNoiseIncrement();
+			_segment[index].lastTime = CAP_ADC_MILLIS();
+			statsBaseline();
 		}
 	}
 
 }
 
 // Get a serie of readings from the bare channel
-uint16_t CapADCSlider::updateRead(uint8_t index){
+uint16_t CapADCSliderBase::updateRead(uint8_t index){
+	uint32_t statsTime = statsStart();
 	int32_t value = 0;
 	// samples sets (2^samples) the number of consecutive reads to be made
 	// More is better filtering, but means a longer time.
 	// We sum all of them, then
 	// divider sets (2^divider) the number we divide the above cumulative read with.
-	uint16_t samples = 1 << _gSettings.samples;
-	uint16_t divider = 1 << _gSettings.divider;
-
-	// Sum up the consecutive reads
-	for(uint16_t i = 0; i < samples; ++i){
-		value += _adcChannel[index]->read();
+	uint16_t samples = 1 << globalSamples();
+	uint16_t conversions;
+
+	if(_scanIndex != CapADCScanner::NoIndex){
+		// The scanner already summed its slots for this channel.
+		value = CapADCScanner::getResult(_scanIndex + index);
+		conversions = CapADCScanner::getSlots(_scanIndex + index);
+	} else {
+		conversions = samples;
+		// Sum up the consecutive reads
+		if(_adcChannel[index].getResolution() == 8 && globalSamples() <= 7){
+			// 8 bits reads can be summed on 16 bits, which is faster.
+			int16_t sum = 0;
+			for(uint16_t i = 0; i < samples; ++i){
+				sum += _adcChannel[index].read();
+			}
+			value = sum;
+		} else {
+			for(uint16_t i = 0; i < samples; ++i){
+				value += _adcChannel[index].read();
+			}
+		}
 	}
-	//Then divide.
-	value /= divider;
+	//Then divide, shifting is much faster than a 32 bits division.
+	value >>= globalDivider();
 
+	statsRead(statsTime, conversions);
 
 	return (uint16_t)value;
 }
@@ -19,74 +19,166 @@
 #ifndef CAP_ADC_SLIDER_H
 #define CAP_ADC_SLIDER_H
 
-#define MAX_SLIDER_CHANNEL		4
-
 #include <Arduino.h>
 #include "CapacitiveADC.h"
 
-class CapADCSlider: public CapADC{
-public:
+// State of one segment of a slider (or wheel), or of one key of a matrix.
+// A slider with N channels has N + 1 segments: the last one is a virtual channel,
+// average of all others, used to detect a touch anywhere on the slider.
+struct CapADCSegment_t{
+	// values from readings
+	uint16_t currentRead;
+	int16_t delta;
+
+	// Settings for filtering
+	uint16_t baseline;
+	uint32_t lastTime;
+	CapADCFilter filter;
+
+	// States of sensing, instant and for reading
+	uint8_t nowState;
+	uint8_t prevState;
+	uint8_t state;
+	uint8_t previousState;
+
+	// Sum and extremes of readings while tuning
+	uint32_t tuneSum;
+	uint32_t tuneCount;
+	uint16_t tuneMin;
+	uint16_t tuneMax;
+
+	CapADCSegment_t():	currentRead(0),
+						delta(0),
+						baseline(0),
+						lastTime(CAP_ADC_MILLIS()),
+						nowState(CapADC::Idle),
+						prevState(CapADC::Idle),
+						state(CapADC::Idle),
+						previousState(CapADC::Idle),
+						tuneSum(0),
+						tuneCount(0),
+						tuneMin(0),
+						tuneMax(0){}
+};
+
+// Compile-time list of indexes 0 to Count - 1, used to build tables from a pack.
+template<uint8_t... Index>
+struct CapADCIndexes{};
+
+template<uint8_t Count, uint8_t... Index>
+struct CapADCMakeIndexes: CapADCMakeIndexes<Count - 1, Count - 1, Index...>{};
+
+template<uint8_t... Index>
+struct CapADCMakeIndexes<0, Index...>{
+	typedef CapADCIndexes<Index...> type;
+};
+
+// Weight of a slider channel: linear from 127 for the first one to -127 for the last one.
+constexpr int8_t capADCSliderWeight(uint8_t index, uint8_t count){
+	return 127 - (254 * index + (count - 1) / 2) / (count - 1);
+}
+
+// Weighting table for a slider of Count channels, computed at compile time.
+// It is shared by all sliders of the same size.
+template<uint8_t Count, typename Indexes = typename CapADCMakeIndexes<Count>::type>
+struct CapADCSliderTable;
+
+template<uint8_t Count, uint8_t... Index>
+struct CapADCSliderTable<Count, CapADCIndexes<Index...> >{
+	static const int8_t weighting[Count];
+};
 
-	CapADCSlider(void);
-	~CapADCSlider(void);
+template<uint8_t Count, uint8_t... Index>
+const int8_t CapADCSliderTable<Count, CapADCIndexes<Index...> >::weighting[Count] = {
+	capADCSliderWeight(Index, Count)...
+};
 
-	virtual void init(uint8_t pin0, uint8_t pin1);
-	void init(uint8_t pin0, uint8_t pin1, uint8_t pin2);
-	void init(uint8_t pin0, uint8_t pin1, uint8_t pin2, uint8_t pin3);
-//	void init(uint8_t pin0, uint8_t pin1, uint8_t pin2, uint8_t pin3, uint8_t pin4);
-//	void init(uint8_t pin0, uint8_t pin1, uint8_t pin2, uint8_t pin3, uint8_t pin4, uint8_t pin5);
+// Slider logic, shared by sliders and wheels of any size.
+// Storage for channels and segments is given by the derived class, sized to its channel count.
+class CapADCSliderBase: public CapADC{
+public:
 
 	void setChargeDelay(uint8_t value);
+	void setResolution(uint8_t bits);
+	void setPrescaler(uint8_t value);
+	void setSleepRead(bool value);
 
+	bool attachScanner(void);
+
+	uint8_t tunePrescaler(uint8_t minRatio = 50);
 	void tuneBaseline(uint32_t length = 200);
 	void tuneThreshold(uint32_t length = 2000);
+	void startTuneBaseline(uint32_t length = 200);
+	void startTuneThreshold(uint32_t length = 2000);
 
 	int16_t update(void);
 
 	bool isTouched(void) const;
+	bool hasPosition(void) const;
 	int8_t getPosition(void) const;
+	int16_t getPosition16(void) const;
 	int8_t getStep(void);
 
 	uint16_t getBaseline(void) const;
 
-//	void applyLocalSettings(const CapADCSetLocal_t& settings);
-//	CapADCSetLocal_t getLocalSettings() const;
+	uint8_t getNumChannels(void) const{return _numChannels;}
 
 protected:
+	CapADCSliderBase(CapADCChannel *channels, CapADCSegment_t *segments,
+						const int8_t *weighting, uint8_t numChannels);
+
+	void initChannels(const uint8_t *pins);
+
 	virtual bool updatePosition(void);
 	uint16_t updateRead(uint8_t index);
 	void updateCal(uint8_t index);
-
-	// The pin linked to this capacitive channel
-	CapADCChannel* _adcChannel[MAX_SLIDER_CHANNEL];
+	void updateTune(void);
+	void resetTune(void);
+	void endTuneBaseline(void);
+	void resetBaselines(void);
+
+	uint8_t getStoredCount(void) const;
+	void saveChannel(uint8_t index, CapADCStoredChannel_t& stored);
+	bool checkChannel(uint8_t index, const CapADCStoredChannel_t& stored, uint16_t maxDrift);
+	void restoreChannel(uint8_t index, const CapADCStoredChannel_t& stored);
+
+	// The pins linked to this slider, numChannels of them
+	CapADCChannel *_adcChannel;
+	// State of each channel, plus the virtual one
+	CapADCSegment_t *_segment;
+	// Position weight of each channel
+	const int8_t *_weighting;
 
 	uint8_t _numChannels;
+	// Index of the first channel in the scanner, if attached. Others follow.
+	uint8_t _scanIndex;
 
-	// Local (pin) settings
-	CapADCSetLocal_t _lSettings;
-
-	// values from readings
-	uint16_t _currentRead[MAX_SLIDER_CHANNEL + 1];
-	uint16_t _previousRead[MAX_SLIDER_CHANNEL + 1];
-	int16_t _delta[MAX_SLIDER_CHANNEL + 1];
-
-	// Settings for filtering
-	uint16_t _baseline[MAX_SLIDER_CHANNEL + 1];
-	uint8_t _resetCounter[MAX_SLIDER_CHANNEL + 1];
-	uint32_t _lastTime[MAX_SLIDER_CHANNEL + 1];
+	// Positions with 8 bits of fraction: the int8_t position is the high byte.
+	int16_t _nowPosition, _prevPosition, _position;
+	int8_t _step;
+};
 
-	// States of sensing, instant and for reading
-	uint8_t _nowState[MAX_SLIDER_CHANNEL + 1];
-	uint8_t _prevState[MAX_SLIDER_CHANNEL + 1];
-	uint8_t _state[MAX_SLIDER_CHANNEL + 1];
-	uint8_t _previousState[MAX_SLIDER_CHANNEL + 1];
+// A slider of Channels electrodes.
+// Use it as CapADCSlider<3> slider; then slider.init(A0, A1, A2);
+template<uint8_t Channels>
+class CapADCSlider: public CapADCSliderBase{
+public:
+	CapADCSlider(void):CapADCSliderBase(_channels, _segments,
+									CapADCSliderTable<Channels>::weighting, Channels){}
 
-	int8_t _nowPosition, _prevPosition, _position;
-	int8_t _step;
+	// Init the object. Tie it to used pins, one per channel, in order along the slider.
+	template<typename... Pins>
+	void init(Pins... pins){
+		static_assert(sizeof...(Pins) == Channels, "init() needs one pin per slider channel");
+		const uint8_t pinList[Channels] = {(uint8_t)pins...};
+		initChannels(pinList);
+	}
 
-	int8_t _weighting[MAX_SLIDER_CHANNEL];
+protected:
+	static_assert(Channels >= 2, "A slider needs at least two channels");
 
-	uint8_t _coeff;
+	CapADCChannel _channels[Channels];
+	CapADCSegment_t _segments[Channels + 1];
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,78 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAP_ADC_STATS_H
+#define CAP_ADC_STATS_H
+
+#include <Arduino.h>
+#include "CapacitiveADCChannel.h"
+#include "CapacitiveADCConfig.h"
+
+// Statistics on what sensors do, to see where time goes.
+// Set stats=1 in the [global] settings and generate CapacitiveADCConfig.h to gather them.
+// Left to 0, they don't use any RAM nor cycle.
+
+// Cycle counter used to time reads and updates.
+// The default one has the resolution of micros(), 4us on a 16MHz board.
+// It can be defined to a finer counter, e.g. Timer1 running at full clock speed.
+#ifndef CAP_ADC_CYCLES
+#define CAP_ADC_CYCLES()			(CAP_ADC_MICROS() * clockCyclesPerMicrosecond())
+#endif
+
+// Timing of an operation: count, total, shortest and longest cycles.
+// Not named min and max, which are macros of the Arduino core.
+struct CapADCTiming_t{
+	uint32_t count;
+	uint32_t total;
+	uint16_t shortest;
+	uint16_t longest;
+
+	CapADCTiming_t():	count(0),
+						total(0),
+						shortest(0xffff),
+						longest(0){}
+
+	void add(uint32_t cycles){
+		if(cycles > 0xffff) cycles = 0xffff;
+		++count;
+		total += cycles;
+		if(cycles < shortest) shortest = cycles;
+		if(cycles > longest) longest = cycles;
+	}
+
+	uint16_t average() const{
+		return count?(total / count):0;
+	}
+};
+
+// Statistics of one sensor (pin, slider or wheel).
+struct CapADCStats_t{
+	uint32_t conversions;				// Channel read sequences, charge and discharge conversions
+	CapADCTiming_t read;				// Cycles per updateRead(), for one channel
+	CapADCTiming_t update;				// Cycles per update()
+	uint32_t baselineAdjust;			// Steps of the baseline drift compensation
+	uint32_t debounceReject;			// Updates where the instant state was not taken yet
+	uint32_t transitions;				// Changes of the debounced state
+
+	CapADCStats_t():	conversions(0),
+						baselineAdjust(0),
+						debounceReject(0),
+						transitions(0){}
+};
+
+#endif
@@ -0,0 +1,98 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CapacitiveADCTelemetry.h"
+
+Print *CapADCTelemetry::_output = 0;
+
+uint8_t CapADCTelemetry::_buffer[CAP_ADC_TELEMETRY_SIZE];
+uint8_t CapADCTelemetry::_head = 0;
+uint8_t CapADCTelemetry::_tail = 0;
+uint16_t CapADCTelemetry::_count = 0;
+
+uint16_t CapADCTelemetry::_dropped = 0;
+
+// Public methods
+
+// Start recording frames, to be sent on output. Open the serial port before.
+void CapADCTelemetry::begin(Print &output){
+	_output = &output;
+	_head = _tail = _count = 0;
+	_dropped = 0;
+}
+
+// Stop recording. Frames not sent yet are lost.
+void CapADCTelemetry::end(){
+	_output = 0;
+}
+
+// Record a frame. Returns false if it was dropped, buffer full or telemetry not started.
+bool CapADCTelemetry::record(uint8_t id, uint8_t state, uint16_t raw, uint16_t filtered,
+							uint16_t baseline, int16_t delta){
+	if(!_output) return false;
+	if(CAP_ADC_TELEMETRY_SIZE - _count < FrameSize){
+		if(_dropped != 0xffff) ++_dropped;
+		return false;
+	}
+
+	uint16_t time = CAP_ADC_MILLIS();
+	uint8_t frame[FrameSize - 2] = {
+		id, state,
+		(uint8_t)time, (uint8_t)(time >> 8),
+		(uint8_t)raw, (uint8_t)(raw >> 8),
+		(uint8_t)filtered, (uint8_t)(filtered >> 8),
+		(uint8_t)baseline, (uint8_t)(baseline >> 8),
+		(uint8_t)delta, (uint8_t)((uint16_t)delta >> 8),
+	};
+
+	uint8_t sum = 0;
+	push(FrameSync);
+	for(uint8_t i = 0; i < FrameSize - 2; ++i){
+		push(frame[i]);
+		sum += frame[i];
+	}
+	push(sum);
+
+	return true;
+}
+
+// Send recorded bytes, as many as the serial transmit buffer takes without waiting.
+void CapADCTelemetry::send(){
+	if(!_output) return;
+
+	int room = _output->availableForWrite();
+	while(_count && room > 0){
+		_output->write(_buffer[_tail]);
+		_tail = (_tail + 1) & (CAP_ADC_TELEMETRY_SIZE - 1);
+		--_count;
+		--room;
+	}
+}
+
+// Number of frames dropped since begin(), because the buffer was full.
+uint16_t CapADCTelemetry::getDropped(){
+	return _dropped;
+}
+
+// Protected methods
+
+void CapADCTelemetry::push(uint8_t value){
+	_buffer[_head] = value;
+	_head = (_head + 1) & (CAP_ADC_TELEMETRY_SIZE - 1);
+	++_count;
+}
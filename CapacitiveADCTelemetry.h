@@ -0,0 +1,71 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAP_ADC_TELEMETRY_H
+#define CAP_ADC_TELEMETRY_H
+
+#include <Arduino.h>
+#include "CapacitiveADCChannel.h"
+#include "CapacitiveADCConfig.h"
+
+// Set telemetry=1 in the [global] settings and generate CapacitiveADCConfig.h to let sensors
+// record frames. Left to 0, they don't record anything.
+// telemetrysize sets the size of the frame buffer, 128 bytes by default.
+
+// Binary stream of sensor values, for tuning and field traces.
+// Sensors record a frame on each update, into a ring buffer. send(), called from the loop,
+// moves the buffer to the serial port only as fast as its transmit buffer empties, so it never blocks.
+// Any Print reporting its room with availableForWrite() fits: Serial, Serial1, the 32U4 USB Serial...
+// When the buffer is full, new frames are dropped and counted.
+//
+// A frame is 14 bytes, little endian:
+// sync (0xA5), id, state, time (ms, 16 bits), raw, filtered, baseline, delta (signed), checksum.
+// The checksum is the sum of the 12 bytes after sync, extras/capadc_telemetry.py decodes frames to CSV.
+class CapADCTelemetry{
+public:
+
+	static const uint8_t FrameSync = 0xA5;
+	static const uint8_t FrameSize = 14;
+	static const uint8_t NoId = 0xff;
+
+	static void begin(Print &output);
+	static void end();
+
+	static bool record(uint8_t id, uint8_t state, uint16_t raw, uint16_t filtered,
+						uint16_t baseline, int16_t delta);
+	static void send();
+
+	static uint16_t getDropped();
+
+protected:
+	static_assert(CAP_ADC_TELEMETRY_SIZE <= 256 && (CAP_ADC_TELEMETRY_SIZE & (CAP_ADC_TELEMETRY_SIZE - 1)) == 0,
+					"CAP_ADC_TELEMETRY_SIZE must be a power of two, up to 256");
+
+	static void push(uint8_t value);
+
+	static Print *_output;
+
+	static uint8_t _buffer[CAP_ADC_TELEMETRY_SIZE];
+	static uint8_t _head;
+	static uint8_t _tail;
+	static uint16_t _count;
+
+	static uint16_t _dropped;
+};
+
+#endif
@@ -18,181 +18,123 @@
 
 #include "CapacitiveADCWheel.h"
 
-// Public methods
-
-// Constructor
-CapADCWheel::CapADCWheel(){
-	for(uint8_t i = 0; i <= MAX_SLIDER_CHANNEL; ++i){
-		_nowState[i] = _prevState[i] = _state[i] = _previousState[i] = Idle;
-		_lastTime[i] = millis();
-		_numChannels = 0;
-	}
-
-	_lSettings.resetCounter = 60;
-	_position = _prevPosition = _nowPosition = _step = 0;
-	_coeff = 83;
-}
-
-// Destructor
-CapADCWheel::~CapADCWheel(){
-	for(uint8_t i = 0; i < _numChannels; ++i){
-		delete _adcChannel[i];
+// Arc tangent of 0 to 1 by steps of 1/32, a full turn being 65536.
+// Linear interpolation between them is within 1/65536 of a turn.
+static const uint16_t PROGMEM atan_table[] = {
+	0, 326, 651, 975, 1297, 1617, 1933, 2246,
+	2555, 2860, 3159, 3453, 3742, 4025, 4302, 4572,
+	4836, 5094, 5344, 5589, 5826, 6058, 6282, 6500,
+	6712, 6917, 7117, 7310, 7498, 7679, 7856, 8026,
+	8192
+};
+
+// Fraction num / den with 16 bits, num being at most den: 16 steps of a long division.
+static uint16_t fraction(uint16_t num, uint16_t den){
+	uint16_t result = 0;
+	for(uint8_t i = 0; i < 16; ++i){
+		// The remainder may need 17 bits once shifted: its carry means it is over den.
+		bool carry = num & 0x8000;
+		num <<= 1;
+		result <<= 1;
+		if(carry || num >= den){
+			num -= den;
+			result |= 1;
+		}
 	}
+	return result;
 }
 
-// Init the object. Tie it to used pins.
-// Init with two pins has no meaning for a wheel, but as wheel inherits from slider, we have to keep it.
-// Don't use it, it returns without doing anything.
-void CapADCWheel::init(uint8_t pin0, uint8_t pin1){
-	return;
-}
+// Angle of the vector x, y, a full turn being 65536.
+static uint16_t atan2Turn(int32_t x, int32_t y){
+	uint32_t ax = (x < 0)?-x:x;
+	uint32_t ay = (y < 0)?-y:y;
 
-void CapADCWheel::init(uint8_t pin0, uint8_t pin1, uint8_t pin2){
-	if(_numChannels != 0) return;
+	// Ratio of the smaller coordinate by the bigger one: only the first eighth of a turn is tabled.
+	// Both are first brought to 16 bits.
+	while((ax | ay) > 0xFFFF){
+		ax >>= 1;
+		ay >>= 1;
+	}
+	bool swap = ay > ax;
+	uint16_t ratio = swap?fraction(ax, ay):fraction(ay, ax);
 
-	_adcChannel[0] = new CapADCChannel();
-	_adcChannel[0]->init(pin0, pin2);
-	_adcChannel[1] = new CapADCChannel();
-	_adcChannel[1]->init(pin1, pin2);
-	_adcChannel[2] = new CapADCChannel();
-	_adcChannel[2]->init(pin2, pin1);
+	uint8_t index = ratio >> 11;
+	uint16_t low = pgm_read_word(atan_table + index);
+	uint16_t high = pgm_read_word(atan_table + index + 1);
+	uint16_t angle = low + (((uint32_t)(high - low) * (ratio & 0x7FF) + 0x400) >> 11);
 
-	_numChannels = 3;
+	if(swap) angle = 16384 - angle;
+	if(x < 0) angle = 32768 - angle;
+	if(y < 0) angle = -angle;
 
-	_weighting[0] = 0;
-	_weighting[1] = 86;
-	_weighting[2] = 171;	
+	return angle;
 }
-/*
-void CapADCWheel::init(uint8_t pin0, uint8_t pin1, uint8_t pin2, uint8_t pin3){
-	if(_numChannels != 0) return;
-
-	_adcChannel[0] = new CapADCChannel();
-	_adcChannel[0]->init(pin0, pin1);
-	_adcChannel[1] = new CapADCChannel();
-	_adcChannel[1]->init(pin1, pin2);
-	_adcChannel[2] = new CapADCChannel();
-	_adcChannel[2]->init(pin2, pin3);
-	_adcChannel[3] = new CapADCChannel();
-	_adcChannel[3]->init(pin3, pin0);
-
-	_numChannels = 4;
-
-	_weighting[0] = 127;
-	_weighting[1] = 42;	
-	_weighting[2] = -42;	
-	_weighting[3] = -127;	
 
+// Constructor
+CapADCWheelBase::CapADCWheelBase(CapADCChannel *channels, CapADCSegment_t *segments,
+									const CapADCWheelVector_t *vector, uint8_t numChannels):
+									CapADCSliderBase(channels, segments, NULL, numChannels){
+	_vector = vector;
 }
-*/
-/*
-// If ever you need more channels for one long slider, you can uncomment this init function.
-// You will have to uncomment also the matching one in CapADCWheel.h,
-// and also change the #define MAX_SLIDER_CHANNEL accordingly.
-// If you ever need even more than 6 channels (wich is unlikely to happen if you use a Uno),
-// just copy the body of the function, and add lines for other channels. ;)
-
-void CapADCWheel::init(uint8_t pin0, uint8_t pin1, uint8_t pin2, uint8_t pin3, uint8_t pin4){
-	if(_numChannels != 0) return;
-
-	_adcChannel[0] = new CapADCChannel();
-	_adcChannel[0]->init(pin0, pin1);
-	_adcChannel[1] = new CapADCChannel();
-	_adcChannel[1]->init(pin1, pin2);
-	_adcChannel[2] = new CapADCChannel();
-	_adcChannel[2]->init(pin2, pin3);
-	_adcChannel[3] = new CapADCChannel();
-	_adcChannel[3]->init(pin3, pin4);
-	_adcChannel[4] = new CapADCChannel();
-	_adcChannel[4]->init(pin4, pin0);
-
-	_numChannels = 5;
-
-	_weighting[0] = 127;
-	_weighting[1] = 32;	
-	_weighting[2] = 0;	
-	_weighting[3] = -32;	
-	_weighting[4] = -127;	
 
-}
+// Protected methods
 
-void CapADCWheel::init(uint8_t pin0, uint8_t pin1, uint8_t pin2, uint8_t pin3, uint8_t pin4, uint8_t pin5){
-	if(_numChannels != 0) return;
-
-	_adcChannel[0] = new CapADCChannel();
-	_adcChannel[0]->init(pin0, pin1);
-	_adcChannel[1] = new CapADCChannel();
-	_adcChannel[1]->init(pin1, pin2);
-	_adcChannel[2] = new CapADCChannel();
-	_adcChannel[2]->init(pin2, pin3);
-	_adcChannel[3] = new CapADCChannel();
-	_adcChannel[3]->init(pin3, pin4);
-	_adcChannel[4] = new CapADCChannel();
-	_adcChannel[4]->init(pin4, pin5);
-	_adcChannel[5] = new CapADCChannel();
-	_adcChannel[5]->init(pin5, pin0);
-
-	_numChannels = 6;
-
-	_weighting[0] = 127;
-	_weighting[1] = 77;	
-	_weighting[2] = 27;	
-	_weighting[3] = -27;
-	_weighting[4] = -77;	
-	_weighting[5] = -127;	
+// Tie channels to pins.
+// A three segments wheel keeps its original friend pins: the third segment for the first two,
+// the second one for the third. Larger wheels use the next segment, as sliders do.
+void CapADCWheelBase::initChannels(const uint8_t *pins){
+	if(_numChannels != 3){
+		CapADCSliderBase::initChannels(pins);
+		return;
+	}
 
+	_adcChannel[0].init(pins[0], pins[2]);
+	_adcChannel[1].init(pins[1], pins[2]);
+	_adcChannel[2].init(pins[2], pins[1]);
 }
-*/
-
-// Protected methods
 
 // Compute current position
-bool CapADCWheel::updatePosition(void){
+bool CapADCWheelBase::updatePosition(void){
 
 	bool touch = false;
-	// If we have a touch, it's time to see where on the slider we are!
-	if(_state[_numChannels] == Touch){
+	// If we have a touch, it's time to see where on the wheel we are!
+	if(_segment[_numChannels].state == Touch){
 		// Keep a track for the last position
 		_prevPosition = _nowPosition;
 
-		int32_t bary0 = 0;
-		int32_t bary1 = 0;
-		int32_t bary2 = 0;
-		int32_t bary = 0;
-
-		bary0 = _coeff * (int32_t)_delta[0];
-		bary1 = _coeff * (int32_t)_delta[1];
-		bary2 = _coeff * (int32_t)_delta[2];
-
-		// Ponderate / total delta
-		bary0 /= _delta[_numChannels];
-		bary1 /= _delta[_numChannels];
-		bary2 /= _delta[_numChannels];
-
-		// We now want to know which of the three is has the strongest touch,
-		// and we adjust calculus regarding its position.
-		if(bary0 > bary1 && bary0 > bary2){
-			// 12 hours
-			bary = _weighting[0] + (bary1 - bary2) / 3;
-		} else if( bary1 >= bary0 && bary1 >= bary2){
-			// 4 hours
-			bary = _weighting[1] + (bary2 - bary0) / 3;
-		} else {
-			// 8 hours
-			bary = _weighting[2] + (bary0 - bary1) / 3;
+		// The touch is around the strongest segment: only it and its two neighbours pull it,
+		// each toward its direction, by its delta. Far segments only hold noise or another finger.
+		uint8_t strongest = 0;
+		for(uint8_t i = 1; i < _numChannels; ++i){
+			if(_segment[i].delta > _segment[strongest].delta) strongest = i;
 		}
 
-		_nowPosition = bary % 256;
+		int32_t x = 0;
+		int32_t y = 0;
+		uint8_t i = (strongest == 0)?(_numChannels - 1):(strongest - 1);
+		for(uint8_t n = 0; n < 3; ++n){
+			int16_t delta = _segment[i].delta;
+			if(delta > 0){
+				x += (int32_t)_vector[i].x * delta;
+				y += (int32_t)_vector[i].y * delta;
+			}
+			if(++i == _numChannels) i = 0;
+		}
+
+		// The position is the direction of their sum.
+		if(x != 0 || y != 0){
+			_nowPosition = atan2Turn(x, y);
+		}
 
 		// If we have two or more consecutive Touch states, we can update position and step
 		// (we don't update on the first touch state to avoid absurd step values:
-		// If it had been touched on one side of the slider, and the new touch is on the other,
+		// If it had been touched on one side of the wheel, and the new touch is on the other,
 		// step would take a great value, altough it's only mean to give a variance
 		// from one read to another.
-		if(_previousState[_numChannels == Touch]){
+		if(_segment[_numChannels].previousState == Touch){
 			touch = true;
 			_position = _nowPosition;
-			_step += _position - _prevPosition;		
+			_step += (int8_t)((_position >> 8) - (_prevPosition >> 8));
 		}
 	}
 
@@ -19,26 +19,102 @@
 #ifndef CAP_ADC_WHEEL_H
 #define CAP_ADC_WHEEL_H
 
-#define MAX_WHEEL_CHANNEL		3
-
 #include <Arduino.h>
 #include "CapacitiveADCSlider.h"
 
-class CapADCWheel: public CapADCSlider{
-public:
+// Direction of each wheel segment, as a unit vector with 12 bits of fraction.
+// Segments are evenly spread around the turn, the first one at angle 0.
+struct CapADCWheelVector_t{
+	int16_t x;
+	int16_t y;
+};
+
+// Sine and cosine series, computed at compile time, for angles from -pi to pi.
+constexpr double capADCSeries(double x2, double term, uint8_t n){
+	return (n > 21)?term:(term + capADCSeries(x2, -term * x2 / ((n + 1) * (n + 2)), n + 2));
+}
+
+constexpr double capADCSin(double x){
+	return capADCSeries(x * x, x, 1);
+}
+
+constexpr double capADCCos(double x){
+	return capADCSeries(x * x, 1, 0);
+}
+
+// Angle of a segment, brought back between -pi and pi.
+constexpr double capADCWheelRadian(uint8_t index, uint8_t count){
+	return 2 * 3.14159265358979 * ((2 * index > count)?((double)index - count):index) / count;
+}
+
+constexpr int16_t capADCWheelQ12(double value){
+	return (int16_t)(value * 4096 + ((value < 0)?-0.5:0.5));
+}
+
+constexpr CapADCWheelVector_t capADCWheelVector(uint8_t index, uint8_t count){
+	return CapADCWheelVector_t{
+		capADCWheelQ12(capADCCos(capADCWheelRadian(index, count))),
+		capADCWheelQ12(capADCSin(capADCWheelRadian(index, count)))
+	};
+}
+
+// Vector table for a wheel of Count segments, computed at compile time.
+template<uint8_t Count, typename Indexes = typename CapADCMakeIndexes<Count>::type>
+struct CapADCWheelTable;
+
+template<uint8_t Count, uint8_t... Index>
+struct CapADCWheelTable<Count, CapADCIndexes<Index...> >{
+	static const CapADCWheelVector_t vector[Count];
+};
 
-	CapADCWheel(void);
-	~CapADCWheel(void);
+template<uint8_t Count, uint8_t... Index>
+const CapADCWheelVector_t CapADCWheelTable<Count, CapADCIndexes<Index...> >::vector[Count] = {
+	capADCWheelVector(Index, Count)...
+};
 
-	void init(uint8_t pin0, uint8_t pin1);
-	void init(uint8_t pin0, uint8_t pin1, uint8_t pin2);
-//	void init(uint8_t pin0, uint8_t pin1, uint8_t pin2, uint8_t pin3);
-//	void init(uint8_t pin0, uint8_t pin1, uint8_t pin2, uint8_t pin3, uint8_t pin4);
-//	void init(uint8_t pin0, uint8_t pin1, uint8_t pin2, uint8_t pin3, uint8_t pin4, uint8_t pin5);
+// Wheel logic, shared by wheels of any size.
+// The position is the angle of the sum of segment directions, weighted by their deltas,
+// over the strongest segment and its two neighbours: far segments don't pull it.
+// It is linear around the turn, 65536 being a full turn and 0 the centre of the first segment.
+// The angle of that sum is computed within 2/65536 of a turn (0.011 degree).
+// With the rounding of segment directions, it is within 5/65536 of the exact angle (0.03 degree)
+// as long as the sum is at least a quarter of the deltas: a touch on one segment or two neighbours is.
+class CapADCWheelBase: public CapADCSliderBase{
+public:
+	uint16_t getAngle(void) const{return _position;}
 
 protected:
+	CapADCWheelBase(CapADCChannel *channels, CapADCSegment_t *segments,
+						const CapADCWheelVector_t *vector, uint8_t numChannels);
+
+	void initChannels(const uint8_t *pins);
 	bool updatePosition(void);
 
+	// Direction of each segment
+	const CapADCWheelVector_t *_vector;
+};
+
+// A wheel of Segments electrodes, from 3 to 12.
+// Use it as CapADCWheel<3> wheel; then wheel.init(A0, A1, A2);
+template<uint8_t Segments>
+class CapADCWheel: public CapADCWheelBase{
+public:
+	CapADCWheel(void):CapADCWheelBase(_channels, _segments,
+								CapADCWheelTable<Segments>::vector, Segments){}
+
+	// Init the object. Tie it to used pins, one per segment, in order around the wheel.
+	template<typename... Pins>
+	void init(Pins... pins){
+		static_assert(sizeof...(Pins) == Segments, "init() needs one pin per wheel segment");
+		const uint8_t pinList[Segments] = {(uint8_t)pins...};
+		initChannels(pinList);
+	}
+
+protected:
+	static_assert(Segments >= 3 && Segments <= 12, "A wheel has 3 to 12 segments");
+
+	CapADCChannel _channels[Segments];
+	CapADCSegment_t _segments[Segments + 1];
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,332 @@
+/*
+ * This is a demo sketch for benchmarking capacitives pins hot paths.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CapacitiveADCPin.h"
+
+// This sketch measures the number of CPU cycles spent in the library hot paths,
+// using Timer1 clocked at F_CPU (ATmega 328p, 32u4, 2560).
+// Results are printed as CSV on the serial port, one line per measure:
+// bench,channels,samples,divider,cycles
+// filter_apply_* lines time apply() alone, one value through each filter policy.
+// The policy is selected at compile time in CapacitiveADCFilter.h: the full update path with it
+// is pin_update and slider_update. filter_update is pin_update with the default settings,
+// named after the policy built, e.g. filter_update:CapADCFilterIIR<40>.
+// make -C extras/simavr bench-filters builds once per policy and collects these lines.
+// ring_push_pop is one read handed from the interrupt to the loop by the scanner.
+// position_divide and position_single compare the slider position computed
+// with one division per channel (former code, kept below) and with one division per update.
+// wheel_neighbours and wheel_atan2 compare the wheel angle interpolated between
+// the strongest segment and its neighbours (former code, kept below) and the arc tangent of the sum
+// of the strongest segment and neighbours vectors. wheel_update is the full update path of a wheel.
+// Capture the serial output to a file to compare builds.
+// A measure that doesn't fit Timer1 (65535 cycles) is reported as -1.
+// Without a board, run it on simavr: make -C extras/simavr bench writes benchmark.csv.
+// The host simulator only counts register accesses, so it reads pure computation as 0 cycles.
+
+#include "CapacitiveADCSlider.h"
+#include "CapacitiveADCWheel.h"
+
+const uint8_t pin0 = A0;
+const uint8_t pin1 = A1;
+const uint8_t pin2 = A2;
+const uint8_t pin3 = A3;
+
+// Name of the filter policy built, for the filter_update line.
+#define CAP_ADC_STRING(x)		CAP_ADC_STRING_(x)
+#define CAP_ADC_STRING_(x)		#x
+
+// Number of runs averaged for each measure.
+const uint8_t runs = 16;
+
+CapADCChannel channel;
+CapADCPin pin;
+CapADCSlider<2> slider2;
+CapADCSlider<3> slider3;
+CapADCSlider<4> slider4;
+CapADCWheel<3> wheel3;
+
+// A slider giving access to its position computation, with the same touch on every run.
+template<uint8_t Channels>
+class BenchSlider: public CapADCSlider<Channels>{
+public:
+	void touch(){
+		this->_segment[Channels].delta = 0;
+		for(uint8_t i = 0; i < Channels; ++i){
+			this->_segment[i].delta = 100 + 37 * i;
+			this->_segment[Channels].delta += this->_segment[i].delta;
+		}
+		this->_segment[Channels].delta /= Channels;
+		this->_segment[Channels].state = CapADC::Touch;
+		this->_segment[Channels].previousState = CapADC::Touch;
+	}
+
+	void positionSingle(){
+		this->updatePosition();
+	}
+
+	// Former position code: each channel delta is divided by the average delta.
+	void positionDivide(){
+		int32_t bary = 0;
+		for(uint8_t i = 0; i < Channels; ++i){
+			int32_t bary0 = 32 * (int32_t)this->_segment[i].delta;
+			bary0 /= this->_segment[Channels].delta;
+			bary += this->_weighting[i] * bary0;
+		}
+		this->_nowPosition = bary / 64;
+	}
+};
+
+// Start the cycle counter.
+void startCount(){
+	TCCR1A = 0;
+	TCCR1B = 0;
+	TCNT1 = 0;
+	TIFR1 = _BV(TOV1);
+	TCCR1B = _BV(CS10);
+}
+
+// Stop the cycle counter, and return the elapsed cycles, -1 on overflow.
+int32_t stopCount(){
+	TCCR1B = 0;
+	if(TIFR1 & _BV(TOV1)) return -1;
+	// Remove the cost of starting and stopping the counter.
+	return TCNT1 - 2;
+}
+
+void printResult(const char* bench, uint8_t channels, uint8_t samples, uint8_t divider, int32_t cycles){
+	Serial.print(bench);
+	Serial.print(',');
+	Serial.print(channels);
+	Serial.print(',');
+	Serial.print(samples);
+	Serial.print(',');
+	Serial.print(divider);
+	Serial.print(',');
+	Serial.println(cycles);
+}
+
+// Average cycles of a measured function over several runs.
+int32_t measure(int32_t (*run)(void)){
+	int32_t sum = 0;
+	for(uint8_t i = 0; i < runs; ++i){
+		int32_t cycles = run();
+		if(cycles < 0) return -1;
+		sum += cycles;
+	}
+	return sum / runs;
+}
+
+int32_t runRead(){
+	startCount();
+	channel.read();
+	return stopCount();
+}
+
+int32_t runPin(){
+	startCount();
+	pin.update();
+	return stopCount();
+}
+
+CapADCSliderBase *currentSlider;
+
+int32_t runSlider(){
+	startCount();
+	currentSlider->update();
+	return stopCount();
+}
+
+// A wheel giving access to its position computation, with the same touch on every run.
+template<uint8_t Segments>
+class BenchWheel: public CapADCWheel<Segments>{
+public:
+	// Angle of each segment on 8 bits, as used by the former position code.
+	BenchWheel(){
+		for(uint8_t i = 0; i < Segments; ++i){
+			angle[i] = (256 * i + Segments / 2) / Segments;
+		}
+	}
+
+	void touch(){
+		for(uint8_t i = 0; i < Segments; ++i){
+			this->_segment[i].delta = (i == 1)?300:((i == 2)?120:10);
+		}
+		this->_segment[Segments].state = CapADC::Touch;
+		this->_segment[Segments].previousState = CapADC::Touch;
+	}
+
+	void positionAtan2(){
+		this->updatePosition();
+	}
+
+	// Former position code: the strongest segment is moved toward its strongest neighbour.
+	void positionNeighbours(){
+		uint8_t strongest = 0;
+		for(uint8_t i = 1; i < Segments; ++i){
+			if(this->_segment[i].delta > this->_segment[strongest].delta) strongest = i;
+		}
+
+		uint8_t prev = (strongest == 0)?(Segments - 1):(strongest - 1);
+		uint8_t next = (strongest == Segments - 1)?0:(strongest + 1);
+
+		int16_t deltaPrev = this->_segment[prev].delta;
+		int16_t deltaNext = this->_segment[next].delta;
+		int16_t deltaStrongest = this->_segment[strongest].delta;
+		if(deltaPrev < 0) deltaPrev = 0;
+		if(deltaNext < 0) deltaNext = 0;
+
+		int32_t sum = (int32_t)deltaPrev + deltaStrongest + deltaNext;
+		int16_t offset = 0;
+		if(sum > 0){
+			offset = ((int32_t)(256 / Segments) * 256 * (deltaNext - deltaPrev)) / sum;
+		}
+
+		this->_nowPosition = (int16_t)(uint16_t)(((uint16_t)angle[strongest] << 8) + offset);
+	}
+
+	uint8_t angle[Segments];
+};
+
+template<typename Wheel>
+int32_t runWheelAtan2(){
+	static Wheel wheel;
+	wheel.touch();
+	startCount();
+	wheel.positionAtan2();
+	return stopCount();
+}
+
+template<typename Wheel>
+int32_t runWheelNeighbours(){
+	static Wheel wheel;
+	wheel.touch();
+	startCount();
+	wheel.positionNeighbours();
+	return stopCount();
+}
+
+template<typename Slider>
+int32_t runPositionSingle(){
+	static Slider slider;
+	slider.touch();
+	startCount();
+	slider.positionSingle();
+	return stopCount();
+}
+
+template<typename Slider>
+int32_t runPositionDivide(){
+	static Slider slider;
+	slider.touch();
+	startCount();
+	slider.positionDivide();
+	return stopCount();
+}
+
+CapADCRing<CapADCSample_t, CAP_ADC_SCAN_RING_SIZE> ring;
+
+int32_t runRing(){
+	CapADCSample_t sample = {1, 500};
+	startCount();
+	ring.push(sample);
+	ring.pop(sample);
+	return stopCount();
+}
+
+// Filters get a varying input, so they don't run on a steady state.
+volatile uint16_t filterInput = 500;
+
+template<typename Filter>
+int32_t runFilter(){
+	static Filter filter;
+	filterInput += 7;
+	startCount();
+	filter.apply(filterInput);
+	return stopCount();
+}
+
+void setup(){
+	Serial.begin(115200);
+	while(!Serial);
+
+	channel.init(pin0, pin1);
+	pin.init(pin0, pin1);
+	slider2.init(pin0, pin1);
+	slider3.init(pin0, pin1, pin2);
+	slider4.init(pin0, pin1, pin2, pin3);
+	wheel3.init(pin0, pin1, pin2);
+
+	pin.tuneBaseline(100);
+	slider2.tuneBaseline(100);
+	slider3.tuneBaseline(100);
+	slider4.tuneBaseline(100);
+	wheel3.tuneBaseline(100);
+
+	Serial.println("bench,channels,samples,divider,cycles");
+
+	printResult("read", 1, 0, 0, measure(runRead));
+
+	CapADCSetGlobal_t *settings = pin.globalSettings();
+	CapADCSetGlobal_t defaults = *settings;
+
+	for(uint8_t samples = 0; samples <= 5; ++samples){
+		for(uint8_t divider = 0; divider <= samples; ++divider){
+			settings->samples = samples;
+			settings->divider = divider;
+			printResult("pin_update", 1, samples, divider, measure(runPin));
+		}
+	}
+
+	*settings = defaults;
+
+	printResult("filter_update:" CAP_ADC_STRING(CAP_ADC_FILTER), 1, settings->samples, settings->divider, measure(runPin));
+
+	printResult("filter_apply_shift2", 1, 0, 0, measure(runFilter<CapADCFilterShift<2> >));
+	printResult("filter_apply_iir40", 1, 0, 0, measure(runFilter<CapADCFilterIIR<40> >));
+	printResult("filter_apply_boxcar4", 1, 0, 0, measure(runFilter<CapADCFilterBoxcar<4> >));
+	printResult("filter_apply_median3", 1, 0, 0, measure(runFilter<CapADCFilterMedian3>));
+
+	printResult("ring_push_pop", 1, 0, 0, measure(runRing));
+
+	printResult("position_divide", 2, 0, 0, measure(runPositionDivide<BenchSlider<2> >));
+	printResult("position_single", 2, 0, 0, measure(runPositionSingle<BenchSlider<2> >));
+	printResult("position_divide", 3, 0, 0, measure(runPositionDivide<BenchSlider<3> >));
+	printResult("position_single", 3, 0, 0, measure(runPositionSingle<BenchSlider<3> >));
+	printResult("position_divide", 4, 0, 0, measure(runPositionDivide<BenchSlider<4> >));
+	printResult("position_single", 4, 0, 0, measure(runPositionSingle<BenchSlider<4> >));
+
+	printResult("wheel_neighbours", 3, 0, 0, measure(runWheelNeighbours<BenchWheel<3> >));
+	printResult("wheel_atan2", 3, 0, 0, measure(runWheelAtan2<BenchWheel<3> >));
+	printResult("wheel_neighbours", 6, 0, 0, measure(runWheelNeighbours<BenchWheel<6> >));
+	printResult("wheel_atan2", 6, 0, 0, measure(runWheelAtan2<BenchWheel<6> >));
+	printResult("wheel_neighbours", 12, 0, 0, measure(runWheelNeighbours<BenchWheel<12> >));
+	printResult("wheel_atan2", 12, 0, 0, measure(runWheelAtan2<BenchWheel<12> >));
+
+	CapADCSliderBase *sliders[3] = {&slider2, &slider3, &slider4};
+	for(uint8_t i = 0; i < 3; ++i){
+		currentSlider = sliders[i];
+		printResult("slider_update", i + 2, settings->samples, settings->divider, measure(runSlider));
+	}
+
+	currentSlider = &wheel3;
+	printResult("wheel_update", 3, settings->samples, settings->divider, measure(runSlider));
+}
+
+void loop(){
+
+}
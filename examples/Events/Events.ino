@@ -0,0 +1,69 @@
+/*
+ * This is a demo sketch for capacitives pins events, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CapacitiveADCPin.h"
+#include "CapacitiveADCSlider.h"
+
+// Work is only done when something happens: update() queues events,
+// dispatchEvents() calls the functions set for them.
+
+CapADCPin button;
+CapADCSlider<3> slider;
+
+void touched(CapADC *sensor){
+	Serial.println((sensor == &button)?"button touched":"slider touched");
+}
+
+void released(CapADC *sensor){
+	Serial.println((sensor == &button)?"button released":"slider released");
+}
+
+void longPress(CapADC *sensor){
+	Serial.println("button long press");
+}
+
+void slid(CapADC *sensor, int8_t delta){
+	Serial.print("slide ");
+	Serial.println(delta);
+}
+
+void setup(){
+	Serial.begin(115200);
+
+	button.init(A4, A5);
+	slider.init(A0, A1, A2);
+
+	button.onTouch(touched);
+	button.onRelease(released);
+	button.onLongPress(longPress, 800);
+
+	slider.onTouch(touched);
+	slider.onRelease(released);
+	slider.onSlide(slid);
+
+	// Tune without blocking: other sensors keep updating meanwhile.
+	button.startTuneThreshold();
+	slider.startTuneThreshold();
+}
+
+void loop(){
+	button.update();
+	slider.update();
+
+	CapADC::dispatchEvents();
+}
@@ -0,0 +1,58 @@
+/*
+ * This is a demo sketch for slider gestures, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CapacitiveADCSlider.h"
+#include "CapacitiveADCGesture.h"
+
+// The gesture recognizer is fed with the slider after each update.
+// It works the same with a wheel.
+
+CapADCSlider<3> slider;
+CapADCGesture gesture;
+
+void setup(){
+	Serial.begin(115200);
+
+	slider.init(A0, A1, A2);
+	slider.tuneThreshold();
+
+	gesture.setLongPressTime(800);
+}
+
+void loop(){
+	slider.update();
+
+	switch(gesture.update(slider)){
+		case CapADCGesture::Tap:
+			Serial.println("tap");
+			break;
+		case CapADCGesture::DoubleTap:
+			Serial.println("double tap");
+			break;
+		case CapADCGesture::LongPress:
+			Serial.println("long press");
+			break;
+		case CapADCGesture::SwipeUp:
+		case CapADCGesture::SwipeDown:
+			Serial.print("swipe, velocity ");
+			Serial.println(gesture.getVelocity());
+			break;
+		default:
+			break;
+	}
+}
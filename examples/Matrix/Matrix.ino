@@ -0,0 +1,53 @@
+/*
+ * This is a demo sketch for a capacitive matrix keypad, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CapacitiveADCMatrix.h"
+
+// A 4 x 4 keypad: rows are electrodes driven by digital pins,
+// columns are electrodes read by ADC pins. 16 keys on 8 pins.
+
+const uint8_t rowPins[4] = {2, 3, 4, 5};
+const uint8_t colPins[4] = {A0, A1, A2, A3};
+
+const char keyNames[] = "123A456B789C*0#D";
+
+CapADCMatrix<4, 4> keypad;
+
+void setup(){
+	Serial.begin(115200);
+
+	keypad.init(rowPins, colPins);
+	// Each update() reads the keys that fit in 2ms, a full scan spans several loops.
+	keypad.setScanBudget(2000);
+	keypad.tuneThreshold();
+
+	Serial.print("scan time (us): ");
+	Serial.println(keypad.getScanTime());
+}
+
+void loop(){
+	keypad.update();
+
+	for(uint8_t row = 0; row < keypad.getNumRows(); ++row){
+		for(uint8_t col = 0; col < keypad.getNumCols(); ++col){
+			if(keypad.isJustTouched(row, col)){
+				Serial.println(keyNames[row * keypad.getNumCols() + col]);
+			}
+		}
+	}
+}
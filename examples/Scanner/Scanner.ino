@@ -0,0 +1,74 @@
+/*
+ * This is a demo sketch for capacitives pins scanned together, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CapacitiveADCPin.h"
+#include "CapacitiveADCSlider.h"
+
+const uint8_t numSense = 2;
+const uint8_t sensePin[numSense] = {A4, A5};
+
+CapADCPin sense[numSense];
+CapADCSlider<3> slider;
+
+void setup(){
+	Serial.begin(115200);
+
+	for(uint8_t i = 0; i < numSense; ++i){
+		sense[i].init(sensePin[i], sensePin[(i + 1) % numSense]);
+		sense[i].attachScanner();
+	}
+
+	slider.init(A0, A1, A2);
+	slider.attachScanner();
+
+	// Scan all the channels, summing 2^samples reads for each, as updateRead() expects.
+	// One scan every 5ms at most, which leaves the CPU to the loop and is fast enough for touch.
+	CapADCScanner::begin(1 << sense[0].getGlobalSettings().samples, 5000);
+	while(!CapADCScanner::isComplete());
+
+	for(uint8_t i = 0; i < numSense; ++i){
+		sense[i].tuneBaseline();
+	}
+	slider.tuneBaseline();
+}
+
+void loop(){
+	// Only process sensors when a new scan is available.
+	if(!CapADCScanner::isComplete()) return;
+
+	for(uint8_t i = 0; i < numSense; ++i){
+		sense[i].update();
+		if(sense[i].isJustTouched()){
+			Serial.print("touch ");
+			Serial.println(i);
+		}
+	}
+
+	if(slider.update()){
+		Serial.println(slider.getPosition());
+	}
+
+	static uint32_t lastPrint = 0;
+	if(millis() - lastPrint > 1000){
+		lastPrint = millis();
+		Serial.print("scans per second: ");
+		Serial.print(CapADCScanner::getScanRate());
+		Serial.print(", overruns: ");
+		Serial.println(CapADCScanner::getOverruns());
+	}
+}
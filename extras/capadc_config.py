@@ -0,0 +1,217 @@
+#!/usr/bin/env python3
+#
+# This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+# Copyright (C) 2017  Pierre-Loup Martin
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Turns a settings file (see settings.ini) into CapacitiveADCConfig.h,
+# a header of constexpr settings the library is compiled with.
+#
+# usage: capadc_config.py [settings.ini] [-o CapacitiveADCConfig.h]
+#
+# Without a settings file, the header gets the library defaults.
+# [global] holds the settings shared by all sensors, [local] the default local settings,
+# other sections each give a CapADCConfig<Section> struct of local settings,
+# e.g. [channel1] gives CapADCConfigChannel1.
+# [global] also holds the layout options, e.g. stats=1 or telemetry=1, that become macros of the header.
+# With fixed=1 in [global], the [local] thresholds are constants used by every sensor,
+# and the other sections only keep their reset counter.
+
+import argparse
+import configparser
+import sys
+
+# ini key: (member, type, default)
+GLOBAL_KEYS = {
+	'fixed':			('fixed', 'bool', 0),
+	'samples':			('samples', 'uint8_t', 4),
+	'divider':			('divider', 'uint8_t', 1),
+	'debounce':			('debounce', 'uint8_t', 2),
+	'noiseincrement':	('noiseIncrement', 'uint8_t', 1),
+	'noiserising':		('noiseCountRising', 'uint16_t', 50),
+	'noisefalling':		('noiseCountFalling', 'uint16_t', 5),
+}
+
+# A prox threshold of 0 leaves proximity detection off.
+LOCAL_KEYS = {
+	'touch':			('touchThreshold', 'int16_t', 50),
+	'release':			('releaseThreshold', 'int16_t', 40),
+	'reset':			('resetCounter', 'uint8_t', 255),
+	'prox':				('proxThreshold', 'int16_t', 0),
+	'proxrelease':		('proxReleaseThreshold', 'int16_t', 0),
+}
+
+# Layout options, in [global]: they add members to the library objects, so they are macros
+# set once here for every file of the build.
+# ini key: (macro, type, default, help)
+OPTION_KEYS = {
+	'stats':			('CAP_ADC_STATS', 'bool', 0, 'Statistics on what sensors do, see CapacitiveADCStats.h.'),
+	'telemetry':		('CAP_ADC_TELEMETRY', 'bool', 0, 'Frames of sensor values, see CapacitiveADCTelemetry.h.'),
+	'telemetrysize':	('CAP_ADC_TELEMETRY_SIZE', 'uint16_t', 128, 'Size of the frame buffer, in bytes. A power of two, up to 256.'),
+}
+
+RANGES = {
+	'bool': (0, 1),
+	'uint8_t': (0, 0xff),
+	'uint16_t': (0, 0xffff),
+	'int16_t': (-0x8000, 0x7fff),
+}
+
+HEADER = '''/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Generated by extras/capadc_config.py from {source}.
+// Edit the settings file and generate this header again rather than editing it.
+
+#ifndef CAP_ADC_CONFIG_H
+#define CAP_ADC_CONFIG_H
+
+#include <stdint.h>
+
+// Global settings, shared by all sensors, and defaults of CapADCSetGlobal_t.
+// When fixed is true they are compile-time constants: update() uses them as immediates,
+// and applyGlobalSettings() doesn't change them anymore. The thresholds of CapADCConfigLocal
+// are then constants for every sensor too, see CapADCThresholds.
+'''
+
+OPTIONS = '''
+// Layout options. They add members to the library objects, so every file of the build must see
+// the same values: a define in a sketch doesn't reach the library files, and is refused.
+// Set them in the settings file, or for the whole build on the compiler command line
+// along with CAP_ADC_GLOBAL_OPTIONS.'''
+
+OPTION = '''
+// {help}
+#if defined({macro}) && !defined(CAP_ADC_GLOBAL_OPTIONS)
+#error "{macro} is set in CapacitiveADCConfig.h, generated from the settings file"
+#endif
+#ifndef {macro}
+#define {macro}{tabs}{value}
+#endif'''
+
+FOOTER = '''
+#endif
+'''
+
+
+def error(message):
+	sys.exit('capadc_config: ' + message)
+
+
+def parse_value(section, key, text, ctype):
+	try:
+		value = int(text, 0)
+	except ValueError:
+		error('[%s] %s: "%s" is not an integer' % (section, key, text))
+
+	low, high = RANGES[ctype]
+	if not low <= value <= high:
+		error('[%s] %s: %d out of range for %s' % (section, key, value, ctype))
+
+	return value
+
+
+def read_section(config, section, keys):
+	values = {}
+	for key, text in config.items(section):
+		if key not in keys:
+			print('capadc_config: [%s] %s: unknown key, skipped' % (section, key), file=sys.stderr)
+			continue
+		values[key] = parse_value(section, key, text, keys[key][1])
+
+	return values
+
+
+def write_struct(out, name, keys, values):
+	out.append('struct %s{' % name)
+	for key, (member, ctype, default) in keys.items():
+		value = values.get(key, default)
+		if ctype == 'bool':
+			text = 'true' if value else 'false'
+		else:
+			text = str(value)
+		out.append('\tstatic constexpr %s %s = %s;' % (ctype, member, text))
+	out.append('};')
+
+
+def write_options(out, values):
+	out.append(OPTIONS)
+	for key, (macro, ctype, default, help) in OPTION_KEYS.items():
+		tabs = '\t' * max(1, (32 - len('#define ' + macro) + 3) // 4)
+		out.append(OPTION.format(help=help, macro=macro, tabs=tabs, value=values.get(key, default)))
+
+
+def struct_name(section):
+	return 'CapADCConfig' + ''.join(part[:1].upper() + part[1:] for part in section.replace('-', '_').split('_'))
+
+
+def main():
+	parser = argparse.ArgumentParser(description='Generate CapacitiveADCConfig.h from a settings file.')
+	parser.add_argument('settings', nargs='?', help='settings file, library defaults if omitted')
+	parser.add_argument('-o', '--output', help='header to write, standard output if omitted')
+	args = parser.parse_args()
+
+	config = configparser.ConfigParser(inline_comment_prefixes=(';', '#'))
+	if args.settings:
+		if not config.read(args.settings):
+			error('cannot read ' + args.settings)
+
+	out = [HEADER.rstrip('\n').format(source=args.settings if args.settings else 'library defaults')]
+
+	global_keys = dict(GLOBAL_KEYS, **OPTION_KEYS)
+	global_values = read_section(config, 'global', global_keys) if config.has_section('global') else {}
+	write_struct(out, 'CapADCConfigGlobal', GLOBAL_KEYS, global_values)
+
+	out.append('')
+	out.append('// Defaults of CapADCSetLocal_t.')
+	values = read_section(config, 'local', LOCAL_KEYS) if config.has_section('local') else {}
+	write_struct(out, 'CapADCConfigLocal', LOCAL_KEYS, values)
+
+	for section in config.sections():
+		if section in ('global', 'local'):
+			continue
+		out.append('')
+		out.append('// Local settings of [%s], apply with capADCLocalSettings<%s>().' % (section, struct_name(section)))
+		write_struct(out, struct_name(section), LOCAL_KEYS, read_section(config, section, LOCAL_KEYS))
+
+	write_options(out, global_values)
+
+	out.append(FOOTER)
+	text = '\n'.join(out)
+
+	if args.output:
+		with open(args.output, 'w') as f:
+			f.write(text)
+	else:
+		sys.stdout.write(text)
+
+
+if __name__ == '__main__':
+	main()
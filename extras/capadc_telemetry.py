@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+#
+# This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+# Copyright (C) 2017  Pierre-Loup Martin
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Decodes the frames sent by CapADCTelemetry into CSV.
+#
+# usage: capadc_telemetry.py INPUT [-b BAUD] [-o trace.csv]
+#
+# INPUT is a serial port (e.g. /dev/ttyACM0, set to BAUD raw mode) or a file holding a capture.
+# Frames with a bad checksum are skipped, and decoding synchronizes again on the next frame.
+# The 16 bits time of frames is unwrapped, so the time column keeps growing.
+
+import argparse
+import os
+import struct
+import sys
+import termios
+import tty
+
+FRAME_SYNC = 0xA5
+FRAME_SIZE = 14
+
+STATES = ['idle', 'baseline', 'rising', 'falling', 'prox', 'touch']
+
+# Rates known to this platform's termios. Others are refused, rather than set to another rate.
+BAUDS = dict((rate, getattr(termios, 'B%d' % rate))
+	for rate in (9600, 57600, 115200, 230400, 460800, 500000, 1000000)
+	if hasattr(termios, 'B%d' % rate))
+
+
+def open_input(path, baud):
+	fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)
+	if os.isatty(fd):
+		if baud not in BAUDS:
+			sys.exit('%s: %d bauds is not supported, use one of %s'
+				% (path, baud, ', '.join(str(rate) for rate in sorted(BAUDS))))
+		tty.setraw(fd)
+		attributes = termios.tcgetattr(fd)
+		attributes[4] = attributes[5] = BAUDS[baud]
+		termios.tcsetattr(fd, termios.TCSANOW, attributes)
+	return fd
+
+
+def frames(fd):
+	"""Yield (id, state, time, raw, filtered, baseline, delta) from the byte stream."""
+	buffer = bytearray()
+	while True:
+		try:
+			data = os.read(fd, 4096)
+		except OSError:
+			# A pseudo-terminal reports EIO once its other end is closed.
+			data = b''
+		if not data:
+			return
+		buffer += data
+
+		while len(buffer) >= FRAME_SIZE:
+			if buffer[0] != FRAME_SYNC:
+				del buffer[0]
+				continue
+
+			body = buffer[1:FRAME_SIZE - 1]
+			if sum(body) & 0xff != buffer[FRAME_SIZE - 1]:
+				del buffer[0]
+				continue
+
+			yield struct.unpack('<BBHHHHh', bytes(body))
+			del buffer[:FRAME_SIZE]
+
+
+def main():
+	parser = argparse.ArgumentParser(description='Decode CapADCTelemetry frames to CSV.')
+	parser.add_argument('input', help='serial port or capture file')
+	parser.add_argument('-b', '--baud', type=int, default=115200, help='serial port rate, 115200 by default')
+	parser.add_argument('-o', '--output', help='CSV file to write, standard output if omitted')
+	args = parser.parse_args()
+
+	fd = open_input(args.input, args.baud)
+	out = open(args.output, 'w') if args.output else sys.stdout
+	out.write('time,id,state,raw,filtered,baseline,delta\n')
+
+	last = None
+	time = 0
+	try:
+		for id, state, stamp, raw, filtered, baseline, delta in frames(fd):
+			if last is not None:
+				time += (stamp - last) & 0xffff
+			last = stamp
+
+			name = STATES[state] if state < len(STATES) else str(state)
+			out.write('%d,%d,%s,%d,%d,%d,%d\n' % (time, id, name, raw, filtered, baseline, delta))
+			out.flush()
+	except KeyboardInterrupt:
+		pass
+
+
+if __name__ == '__main__':
+	main()
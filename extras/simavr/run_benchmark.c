@@ -0,0 +1,91 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Runs a firmware on a simavr core, and copies what it sends on UART 0 to the standard output.
+// The Benchmark sketch prints its results from setup() then idles in loop(): the run stops once
+// the UART has been quiet for a second of simulated time after its first byte, or after a minute.
+// Usage: run_benchmark firmware.elf
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "sim_avr.h"
+#include "sim_elf.h"
+#include "avr_uart.h"
+
+static avr_t *avr;
+static avr_cycle_count_t lastByte;
+static int started;
+
+// Every byte the firmware sends.
+static void uartOutput(struct avr_irq_t *irq, uint32_t value, void *param){
+	(void)irq;
+	(void)param;
+	putchar((char)value);
+	lastByte = avr->cycle;
+	started = 1;
+}
+
+int main(int argc, char *argv[]){
+	if(argc != 2){
+		fprintf(stderr, "usage: %s firmware.elf\n", argv[0]);
+		return 2;
+	}
+
+	elf_firmware_t firmware = {0};
+	if(elf_read_firmware(argv[1], &firmware) != 0){
+		fprintf(stderr, "%s: can't read %s\n", argv[0], argv[1]);
+		return 1;
+	}
+
+	avr = avr_make_mcu_by_name(MCU);
+	if(!avr){
+		fprintf(stderr, "%s: simavr has no %s core\n", argv[0], MCU);
+		return 1;
+	}
+	avr_init(avr);
+	firmware.frequency = F_CPU;
+	avr_load_firmware(avr, &firmware);
+
+	// The output goes to stdout through the hook only, not through simavr own console.
+	uint32_t flags = 0;
+	avr_ioctl(avr, AVR_IOCTL_UART_GET_FLAGS('0'), &flags);
+	flags &= ~AVR_UART_FLAG_STDIO;
+	avr_ioctl(avr, AVR_IOCTL_UART_SET_FLAGS('0'), &flags);
+	avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUTPUT), uartOutput, NULL);
+
+	const avr_cycle_count_t quiet = F_CPU;
+	const avr_cycle_count_t limit = (avr_cycle_count_t)F_CPU * 60;
+
+	int state = cpu_Running;
+	while(state != cpu_Done && state != cpu_Crashed){
+		state = avr_run(avr);
+		if(started && avr->cycle - lastByte > quiet) break;
+		if(avr->cycle > limit){
+			fprintf(stderr, "%s: no end of output after 60s\n", argv[0]);
+			return 1;
+		}
+	}
+
+	fflush(stdout);
+	if(state == cpu_Crashed){
+		fprintf(stderr, "%s: the core crashed\n", argv[0]);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,135 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Arduino core subset over the simulated ATmega328P, for host builds of the library.
+// Pins are numbered as on an Uno: 0-7 on port D, 8-13 on port B, A0-A5 (14-19) on port C.
+
+#ifndef CAP_ADC_SIM_ARDUINO_H
+#define CAP_ADC_SIM_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef uint16_t word;
+
+#define HIGH						0x1
+#define LOW							0x0
+
+#define INPUT						0x0
+#define OUTPUT						0x1
+#define INPUT_PULLUP				0x2
+
+// As in the Arduino core, where they are macros too.
+#define min(a, b)					((a) < (b) ? (a) : (b))
+#define max(a, b)					((a) > (b) ? (a) : (b))
+
+#define NUM_DIGITAL_PINS			20
+#define NUM_ANALOG_INPUTS			6
+
+#define A0							14
+#define A1							15
+#define A2							16
+#define A3							17
+#define A4							18
+#define A5							19
+
+#define NOT_A_PIN					0
+#define NOT_A_PORT					0
+#define PB							2
+#define PC							3
+#define PD							4
+
+#define clockCyclesPerMicrosecond()	(F_CPU / 1000000L)
+
+uint8_t digitalPinToPort(uint8_t pin);
+uint8_t digitalPinToBitMask(uint8_t pin);
+volatile uint8_t* portOutputRegister(uint8_t port);
+volatile uint8_t* portInputRegister(uint8_t port);
+volatile uint8_t* portModeRegister(uint8_t port);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+class Print{
+public:
+	virtual ~Print(){}
+
+	virtual size_t write(uint8_t data) = 0;
+	virtual size_t write(const uint8_t *buffer, size_t size);
+	size_t write(const char *str){return str?write((const uint8_t*)str, strlen(str)):0;}
+	virtual int availableForWrite(){return 0;}
+
+	size_t print(const char *str){return write(str);}
+	size_t print(char c){return write((uint8_t)c);}
+	size_t print(long value, int base = 10);
+	size_t print(unsigned long value, int base = 10);
+	size_t print(int value, int base = 10){return print((long)value, base);}
+	size_t print(unsigned int value, int base = 10){return print((unsigned long)value, base);}
+	size_t print(double value, int digits = 2);
+	size_t println(){return write("\r\n");}
+	template<typename T> size_t println(T value){size_t n = print(value); return n + println();}
+	template<typename T> size_t println(T value, int format){size_t n = print(value, format); return n + println();}
+};
+
+class Stream: public Print{
+public:
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int peek() = 0;
+};
+
+// Serial port writing to a buffer the simulator gives back, see CapADCSim::serial().
+class HardwareSerial: public Stream{
+public:
+	void begin(unsigned long baud){(void)baud;}
+	void end(){}
+	operator bool(){return true;}
+
+	virtual int available(){return 0;}
+	virtual int read(){return -1;}
+	virtual int peek(){return -1;}
+
+	virtual int availableForWrite();
+	virtual size_t write(uint8_t data);
+	using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+// Library busy-wait loops let the simulated time pass.
+#ifndef CAP_ADC_WAIT
+#define CAP_ADC_WAIT()				CapADCSimIdle()
+#endif
+void CapADCSimIdle();
+
+#endif
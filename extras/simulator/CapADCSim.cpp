@@ -0,0 +1,864 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CapADCSim.h"
+
+#include <avr/sleep.h>
+#include <EEPROM.h>
+
+#include <stdio.h>
+
+// Vectors the program may define.
+extern "C" void TIMER2_COMPA_vect(void) __attribute__((weak));
+extern "C" void ADC_vect(void) __attribute__((weak));
+
+enum{
+	RegSREG = 0,
+	RegSMCR,
+	RegADMUX,
+	RegADCSRA,
+	RegADCSRB,
+	RegADCL,
+	RegADCH,
+	RegTCCR1A,
+	RegTCCR1B,
+	RegTCNT1,
+	RegTIFR1,
+	RegTCCR2A,
+	RegTCCR2B,
+	RegTCNT2,
+	RegOCR2A,
+	RegTIMSK2,
+	RegTIFR2,
+	RegCount,
+};
+
+CapADCSimRegister SREG(RegSREG);
+CapADCSimRegister SMCR(RegSMCR);
+CapADCSimRegister ADMUX(RegADMUX);
+CapADCSimRegister ADCSRA(RegADCSRA);
+CapADCSimRegister ADCSRB(RegADCSRB);
+CapADCSimRegister ADCL(RegADCL);
+CapADCSimRegister ADCH(RegADCH);
+CapADCSimRegister TCCR1A(RegTCCR1A);
+CapADCSimRegister TCCR1B(RegTCCR1B);
+CapADCSimRegister16 TCNT1(RegTCNT1);
+CapADCSimRegister TIFR1(RegTIFR1);
+CapADCSimRegister TCCR2A(RegTCCR2A);
+CapADCSimRegister TCCR2B(RegTCCR2B);
+CapADCSimRegister TCNT2(RegTCNT2);
+CapADCSimRegister OCR2A(RegOCR2A);
+CapADCSimRegister TIMSK2(RegTIMSK2);
+CapADCSimRegister TIFR2(RegTIFR2);
+
+volatile uint8_t PORTB, DDRB, PINB;
+volatile uint8_t PORTC, DDRC, PINC;
+volatile uint8_t PORTD, DDRD, PIND;
+volatile uint8_t DIDR0;
+
+HardwareSerial Serial;
+EEPROMClass EEPROM;
+
+namespace{
+	const uint64_t Never = ~(uint64_t)0;
+
+	// Electrical values, from the ATmega328P datasheet where it gives them.
+	const double Vcc = 5.0;
+	const double BandGap = 1.1;
+	const double TemperatureSensor = 0.314;
+	const double SampleHold = 14e-12;
+	const double MuxResistance = 10e3;
+	const double DriverResistance = 25;
+	const double PullUpResistance = 35e3;
+	const double PinCapacitance = 10;
+
+	// Cycles taken by an interrupt entry and by its return.
+	const uint8_t InterruptCycles = 4;
+
+	struct Electrode_t{
+		double capacitance;
+		double touch;
+		double resistance;
+		double voltage;
+	};
+
+	struct Coupling_t{
+		uint8_t drivePin;
+		uint8_t pin;
+		double capacitance;
+	};
+
+	const uint8_t MaxCouplings = 64;
+
+	uint8_t reg[RegCount];
+
+	uint64_t now;
+	uint64_t settled;
+
+	Electrode_t electrode[NUM_ANALOG_INPUTS];
+	double holdVoltage;
+	Coupling_t coupling[MaxCouplings];
+	uint8_t couplings;
+	double driveLevel[NUM_DIGITAL_PINS];
+
+	bool converting;
+	bool holding;
+	bool firstConversion;
+	bool awakeConverting;
+	uint64_t adcEnabledAt;
+	uint64_t sampleAt;
+	uint64_t doneAt;
+	double sampled;
+	uint16_t result;
+
+	uint64_t timerRef;
+	uint8_t timerCount;
+	uint64_t matchAt;
+
+	uint64_t timer1Ref;
+	uint16_t timer1Count;
+
+	bool inInterrupt;
+	bool asleep;
+	uint32_t conversions;
+	uint32_t interrupts;
+
+	double noise;
+	double clockNoise;
+	uint32_t ratedClock;
+	double digitalNoise;
+	double mainsVolts;
+	double mainsHertz;
+	uint32_t randomState;
+
+	uint8_t eeprom[1024];
+	std::string serialOutput;
+
+	double uniform(){
+		randomState ^= randomState << 13;
+		randomState ^= randomState >> 17;
+		randomState ^= randomState << 5;
+		return (randomState + 1.0) / 4294967297.0;
+	}
+
+	double gaussian(){
+		return sqrt(-2 * log(uniform())) * cos(2 * M_PI * uniform());
+	}
+
+	double relax(double value, double target, double dt, double tau){
+		return target + (value - target) * exp(-dt / tau);
+	}
+
+	volatile uint8_t* portOf(uint8_t pin, uint8_t &mask, volatile uint8_t *&ddr){
+		mask = digitalPinToBitMask(pin);
+		uint8_t port = digitalPinToPort(pin);
+		ddr = portModeRegister(port);
+		return portOutputRegister(port);
+	}
+
+	// Level of a digital pin driven as an output, negative when it floats.
+	double outputLevel(uint8_t pin){
+		uint8_t mask;
+		volatile uint8_t *ddr;
+		volatile uint8_t *port = portOf(pin, mask, ddr);
+		if(!port || !(*ddr & mask)) return -1;
+		return (*port & mask)?Vcc:0;
+	}
+
+	// Capacitance of an electrode to ground, drive pins included.
+	double capacitance(uint8_t index){
+		double value = electrode[index].capacitance + electrode[index].touch;
+		for(uint8_t i = 0; i < couplings; ++i){
+			if(coupling[i].pin == A0 + index) value += coupling[i].capacitance;
+		}
+		return value * 1e-12;
+	}
+
+	bool isConnected(uint8_t index){
+		return !holding && ((reg[RegADMUX] & 0x0F) == index);
+	}
+
+	// Edges of drive pins inject charge in the electrodes they are coupled to.
+	void injectEdges(){
+		for(uint8_t i = 0; i < couplings; ++i){
+			uint8_t pin = coupling[i].drivePin;
+			double level = outputLevel(pin);
+			double last = driveLevel[pin];
+			if(level == last) continue;
+			driveLevel[pin] = level;
+			if(level < 0 || last < 0) continue;
+
+			for(uint8_t j = 0; j < couplings; ++j){
+				if(coupling[j].drivePin != pin) continue;
+				uint8_t index = coupling[j].pin - A0;
+				if(DDRC & _BV(index)) continue;
+				double total = capacitance(index);
+				bool connected = isConnected(index);
+				if(connected) total += SampleHold;
+				double step = coupling[j].capacitance * 1e-12 * (level - last) / total;
+				electrode[index].voltage += step;
+				if(connected) holdVoltage += step;
+			}
+		}
+	}
+
+	// Brings the analog state up to the current cycle.
+	void settle(){
+		if(now <= settled) return;
+		double dt = (now - settled) / (double)F_CPU;
+		settled = now;
+
+		injectEdges();
+
+		uint8_t mux = reg[RegADMUX] & 0x0F;
+		uint8_t pins = 0;
+		for(uint8_t i = 0; i < NUM_ANALOG_INPUTS; ++i){
+			Electrode_t &e = electrode[i];
+			uint8_t mask = _BV(i);
+			double c = capacitance(i);
+			bool connected = isConnected(i);
+			if(DDRC & mask){
+				double level = (PORTC & mask)?Vcc:0;
+				e.voltage = relax(e.voltage, level, dt, (DriverResistance + e.resistance) * c);
+				if(connected) holdVoltage = relax(holdVoltage, level, dt, MuxResistance * SampleHold);
+			} else {
+				if(PORTC & mask) e.voltage = relax(e.voltage, Vcc, dt, (PullUpResistance + e.resistance) * c);
+				if(connected){
+					// Charge sharing between the electrode and the sample and hold capacitor.
+					double shared = (c * e.voltage + SampleHold * holdVoltage) / (c + SampleHold);
+					double tau = (MuxResistance + e.resistance) * c * SampleHold / (c + SampleHold);
+					e.voltage = relax(e.voltage, shared, dt, tau);
+					holdVoltage = relax(holdVoltage, shared, dt, tau);
+				}
+			}
+			if(e.voltage > Vcc / 2) pins |= mask;
+		}
+
+		if(!holding && mux >= NUM_ANALOG_INPUTS){
+			double level = 0;
+			if(mux == 8) level = TemperatureSensor;
+			else if(mux == 14) level = BandGap;
+			holdVoltage = relax(holdVoltage, level, dt, MuxResistance * SampleHold);
+		}
+
+		PINB = PORTB;
+		PINC = pins;
+		PIND = PORTD;
+	}
+
+	double reference(){
+		switch(reg[RegADMUX] >> 6){
+			case 3:
+				return BandGap;
+			default:
+				return Vcc;
+		}
+	}
+
+	uint8_t adcDivider(){
+		uint8_t prescaler = reg[RegADCSRA] & 0x07;
+		return prescaler?(1 << prescaler):2;
+	}
+
+	void startConversion(){
+		uint8_t divider = adcDivider();
+		// Conversions start on an edge of the ADC clock, counted from the ADC enable.
+		uint64_t start = adcEnabledAt + ((now - adcEnabledAt + divider - 1) / divider) * divider;
+		converting = true;
+		holding = false;
+		sampleAt = start + (firstConversion?27:3) * divider / 2;
+		doneAt = start + (firstConversion?25:13) * divider;
+		firstConversion = false;
+		awakeConverting = !asleep;
+		reg[RegADCSRA] |= _BV(ADSC);
+	}
+
+	void sample(){
+		holding = true;
+		double vref = reference();
+		double lsb = noise;
+		// The sample and hold settles less, and the comparator is less accurate, on faster clocks.
+		double clock = (double)F_CPU / adcDivider();
+		if(clock > ratedClock) lsb += clockNoise * (clock - ratedClock) / 1e6;
+		sampled = holdVoltage + gaussian() * lsb * vref / 1024;
+		if((reg[RegADMUX] & 0x0F) < NUM_ANALOG_INPUTS){
+			sampled += mainsVolts * sin(2 * M_PI * mainsHertz * now / F_CPU);
+		}
+	}
+
+	void conversionDone(){
+		// The CPU and I/O clocks switching couple into the analog front end while the conversion
+		// runs, unless they are stopped for all of it.
+		if(awakeConverting) sampled += gaussian() * digitalNoise * reference() / 1024;
+		long value = lround(sampled / reference() * 1024);
+		if(value < 0) value = 0;
+		if(value > 1023) value = 1023;
+		result = value;
+		converting = false;
+		holding = false;
+		++conversions;
+		reg[RegADCSRA] = (reg[RegADCSRA] & ~_BV(ADSC)) | _BV(ADIF);
+	}
+
+	// Counts timer 1 up to the current cycle, setting TOV1 when it wraps.
+	void syncTimer1(){
+		static const uint16_t divider[8] = {0, 1, 8, 64, 256, 1024, 0, 0};
+		uint16_t div = divider[reg[RegTCCR1B] & 0x07];
+		if(!div){
+			timer1Ref = now;
+			return;
+		}
+		uint64_t ticks = (now - timer1Ref) / div;
+		timer1Ref += ticks * div;
+		if(timer1Count + ticks > 0xFFFF) reg[RegTIFR1] |= _BV(TOV1);
+		timer1Count += ticks;
+	}
+
+	uint16_t timerDivider(){
+		static const uint16_t divider[8] = {0, 1, 8, 32, 64, 128, 256, 1024};
+		return divider[reg[RegTCCR2B] & 0x07];
+	}
+
+	bool isCTC(){
+		return ((reg[RegTCCR2A] & 0x03) == _BV(WGM21)) && !(reg[RegTCCR2B] & _BV(WGM22));
+	}
+
+	// Counts the timer up to the current cycle.
+	void syncTimer(){
+		uint16_t divider = timerDivider();
+		if(!divider){
+			timerRef = now;
+			return;
+		}
+		uint64_t ticks = (now - timerRef) / divider;
+		timerRef += ticks * divider;
+		uint16_t top = isCTC()?reg[RegOCR2A]:0xFF;
+		uint16_t count = timerCount;
+		if(count > top){
+			// Past TOP, the counter runs up to 0xFF before wrapping.
+			if(ticks < (uint64_t)(0x100 - count)){
+				timerCount = count + ticks;
+				return;
+			}
+			ticks -= 0x100 - count;
+			count = 0;
+		}
+		timerCount = (count + ticks) % (top + 1);
+	}
+
+	void scheduleTimer(){
+		uint16_t divider = timerDivider();
+		if(!divider){
+			matchAt = Never;
+			return;
+		}
+		uint16_t compare = reg[RegOCR2A];
+		uint16_t count = timerCount;
+		uint16_t ticks;
+		if(count < compare){
+			ticks = compare - count;
+		} else if(count == compare){
+			ticks = isCTC()?(compare + 1):0x100;
+		} else {
+			ticks = 0x100 - count + compare;
+		}
+		matchAt = timerRef + (uint64_t)ticks * divider;
+	}
+
+	void compareMatch(){
+		syncTimer();
+		reg[RegTIFR2] |= _BV(OCF2A);
+		scheduleTimer();
+	}
+
+	uint64_t nextEvent(){
+		uint64_t at = matchAt;
+		if(converting){
+			uint64_t conversion = holding?doneAt:sampleAt;
+			if(conversion < at) at = conversion;
+		}
+		return at;
+	}
+
+	void take(void (*vector)(void)){
+		// Any interrupt wakes the CPU up.
+		asleep = false;
+		if(converting) awakeConverting = true;
+		inInterrupt = true;
+		reg[RegSREG] &= ~_BV(SREG_I);
+		++interrupts;
+		CapADCSim::advance(InterruptCycles);
+		vector();
+		CapADCSim::advance(InterruptCycles);
+		reg[RegSREG] |= _BV(SREG_I);
+		inInterrupt = false;
+	}
+
+	// Takes pending interrupts, lowest vector first, as long as they are enabled.
+	void dispatch(){
+		if(inInterrupt) return;
+		while(reg[RegSREG] & _BV(SREG_I)){
+			if((reg[RegTIFR2] & _BV(OCF2A)) && (reg[RegTIMSK2] & _BV(OCIE2A)) && TIMER2_COMPA_vect){
+				reg[RegTIFR2] &= ~_BV(OCF2A);
+				take(TIMER2_COMPA_vect);
+			} else if((reg[RegADCSRA] & _BV(ADIF)) && (reg[RegADCSRA] & _BV(ADIE)) && ADC_vect){
+				reg[RegADCSRA] &= ~_BV(ADIF);
+				take(ADC_vect);
+			} else {
+				break;
+			}
+		}
+	}
+
+	void advanceTo(uint64_t target){
+		for(;;){
+			uint64_t at = nextEvent();
+			if(at > target) break;
+			if(at > now) now = at;
+			settle();
+			if(at == matchAt) compareMatch();
+			if(converting && !holding && at == sampleAt) sample();
+			else if(converting && holding && at == doneAt) conversionDone();
+			dispatch();
+		}
+		if(now < target) now = target;
+		settle();
+	}
+
+	uint8_t readRegister(uint8_t id){
+		switch(id){
+			case RegADCL:
+				return (reg[RegADMUX] & _BV(ADLAR))?(result << 6):result;
+			case RegADCH:
+				return (reg[RegADMUX] & _BV(ADLAR))?(result >> 2):(result >> 8);
+			case RegTCNT2:
+				syncTimer();
+				return timerCount;
+			case RegTIFR1:
+				syncTimer1();
+				return reg[id];
+			default:
+				return reg[id];
+		}
+	}
+
+	void writeRegister(uint8_t id, uint8_t value){
+		switch(id){
+			case RegADCSRA:{
+				uint8_t old = reg[RegADCSRA];
+				uint8_t kept = (old & (_BV(ADIF) | _BV(ADSC))) & ~(value & _BV(ADIF));
+				reg[RegADCSRA] = (value & ~(_BV(ADIF) | _BV(ADSC))) | kept;
+				if(!(value & _BV(ADEN))){
+					converting = false;
+					holding = false;
+					reg[RegADCSRA] &= ~_BV(ADSC);
+				} else if(!(old & _BV(ADEN))){
+					firstConversion = true;
+					adcEnabledAt = now;
+				}
+				if((value & _BV(ADSC)) && (value & _BV(ADEN)) && !converting) startConversion();
+				break;
+			}
+			case RegADCL:
+			case RegADCH:
+				break;
+			case RegTIFR2:
+				reg[RegTIFR2] &= ~value;
+				break;
+			case RegTIFR1:
+				syncTimer1();
+				reg[RegTIFR1] &= ~value;
+				break;
+			case RegTCCR1A:
+			case RegTCCR1B:
+				syncTimer1();
+				reg[id] = value;
+				break;
+			case RegTCCR2A:
+			case RegTCCR2B:
+			case RegOCR2A:
+				syncTimer();
+				reg[id] = value;
+				scheduleTimer();
+				break;
+			case RegTCNT2:
+				timerCount = value;
+				timerRef = now;
+				scheduleTimer();
+				break;
+			default:
+				reg[id] = value;
+				break;
+		}
+		dispatch();
+	}
+
+	// The state left by the Arduino core init(): interrupts enabled, ADC enabled
+	// with a 128 prescaler, timer 2 in phase correct PWM with a 64 prescaler.
+	struct PowerOn{
+		PowerOn(){
+			CapADCSim::reset();
+		}
+	} powerOn;
+}
+
+CapADCSimRegister::operator uint8_t() const{
+	CapADCSim::advance(1);
+	return readRegister(_id);
+}
+
+CapADCSimRegister& CapADCSimRegister::operator=(uint8_t value){
+	CapADCSim::advance(1);
+	writeRegister(_id, value);
+	return *this;
+}
+
+// Timer 1 is the only 16 bits register. The low byte is read first, the count is latched then.
+CapADCSimRegister16::operator uint16_t() const{
+	CapADCSim::advance(1);
+	syncTimer1();
+	uint16_t value = timer1Count;
+	CapADCSim::advance(1);
+	return value;
+}
+
+// The high byte is written first, the count is set with the low one.
+CapADCSimRegister16& CapADCSimRegister16::operator=(uint16_t value){
+	CapADCSim::advance(2);
+	syncTimer1();
+	timer1Count = value;
+	timer1Ref = now;
+	return *this;
+}
+
+void CapADCSim::reset(uint32_t seed){
+	memset(reg, 0, sizeof(reg));
+	reg[RegSREG] = _BV(SREG_I);
+	reg[RegADCSRA] = _BV(ADEN) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+	reg[RegTCCR2A] = _BV(WGM20);
+	reg[RegTCCR2B] = _BV(CS22);
+
+	PORTB = DDRB = PINB = 0;
+	PORTC = DDRC = PINC = 0;
+	PORTD = DDRD = PIND = 0;
+	DIDR0 = 0;
+
+	now = 0;
+	settled = 0;
+
+	for(uint8_t i = 0; i < NUM_ANALOG_INPUTS; ++i){
+		electrode[i].capacitance = PinCapacitance;
+		electrode[i].touch = 0;
+		electrode[i].resistance = 0;
+		electrode[i].voltage = 0;
+	}
+	holdVoltage = 0;
+	couplings = 0;
+	for(uint8_t i = 0; i < NUM_DIGITAL_PINS; ++i){
+		driveLevel[i] = -1;
+	}
+
+	converting = false;
+	holding = false;
+	firstConversion = true;
+	awakeConverting = false;
+	adcEnabledAt = 0;
+	result = 0;
+
+	timerRef = 0;
+	timerCount = 0;
+	scheduleTimer();
+
+	timer1Ref = 0;
+	timer1Count = 0;
+
+	inInterrupt = false;
+	asleep = false;
+	conversions = 0;
+	interrupts = 0;
+
+	noise = 0.5;
+	clockNoise = 0;
+	ratedClock = 1000000;
+	digitalNoise = 0;
+	mainsVolts = 0;
+	mainsHertz = 50;
+	randomState = seed?seed:1;
+
+	memset(eeprom, 0xFF, sizeof(eeprom));
+	serialOutput.clear();
+}
+
+uint64_t CapADCSim::cycles(){
+	return now;
+}
+
+void CapADCSim::advance(uint32_t cycles){
+	advanceTo(now + cycles);
+}
+
+void CapADCSim::run(uint32_t us){
+	advanceTo(now + (uint64_t)us * clockCyclesPerMicrosecond());
+}
+
+void CapADCSim::setElectrode(uint8_t pin, float capacitance, float resistance){
+	settle();
+	electrode[pin - A0].capacitance = capacitance;
+	electrode[pin - A0].resistance = resistance;
+}
+
+void CapADCSim::setTouch(uint8_t pin, float capacitance){
+	settle();
+	electrode[pin - A0].touch = capacitance;
+}
+
+void CapADCSim::setCoupling(uint8_t drivePin, uint8_t pin, float capacitance){
+	settle();
+	for(uint8_t i = 0; i < couplings; ++i){
+		if(coupling[i].drivePin == drivePin && coupling[i].pin == pin){
+			coupling[i].capacitance = capacitance;
+			return;
+		}
+	}
+	if(couplings == MaxCouplings) return;
+	coupling[couplings].drivePin = drivePin;
+	coupling[couplings].pin = pin;
+	coupling[couplings].capacitance = capacitance;
+	driveLevel[drivePin] = outputLevel(drivePin);
+	++couplings;
+}
+
+void CapADCSim::setNoise(float lsb){
+	noise = lsb;
+}
+
+void CapADCSim::setClockNoise(float lsbPerMHz, uint32_t rated){
+	clockNoise = lsbPerMHz;
+	ratedClock = rated;
+}
+
+void CapADCSim::setDigitalNoise(float lsb){
+	digitalNoise = lsb;
+}
+
+void CapADCSim::setMains(float volts, float hertz){
+	mainsVolts = volts;
+	mainsHertz = hertz;
+}
+
+float CapADCSim::getVoltage(uint8_t pin){
+	settle();
+	return electrode[pin - A0].voltage;
+}
+
+uint32_t CapADCSim::getConversions(){
+	return conversions;
+}
+
+uint32_t CapADCSim::getInterrupts(){
+	return interrupts;
+}
+
+std::string& CapADCSim::serial(){
+	return serialOutput;
+}
+
+void cli(){
+	CapADCSim::advance(1);
+	reg[RegSREG] &= ~_BV(SREG_I);
+}
+
+void sei(){
+	CapADCSim::advance(1);
+	reg[RegSREG] |= _BV(SREG_I);
+	dispatch();
+}
+
+void sleep_cpu(){
+	CapADCSim::advance(1);
+	if(!(reg[RegSMCR] & _BV(SE))) return;
+
+	uint8_t mode = reg[RegSMCR] & (_BV(SM0) | _BV(SM1) | _BV(SM2));
+	asleep = (mode == SLEEP_MODE_ADC);
+	if(asleep && (reg[RegADCSRA] & _BV(ADEN)) && !converting) startConversion();
+
+	uint32_t taken = interrupts;
+	while(interrupts == taken){
+		uint64_t at = nextEvent();
+		if(at == Never){
+			// Nothing left to wake the CPU up: the target would sleep forever.
+			fprintf(stderr, "CapADCSim: sleep_cpu() without any wake-up source\n");
+			asleep = false;
+			return;
+		}
+		advanceTo((at > now)?at:(now + 1));
+	}
+}
+
+void CapADCSimIdle(){
+	CapADCSim::advance(4);
+}
+
+uint8_t digitalPinToPort(uint8_t pin){
+	if(pin < 8) return PD;
+	if(pin < 14) return PB;
+	if(pin < NUM_DIGITAL_PINS) return PC;
+	return NOT_A_PORT;
+}
+
+uint8_t digitalPinToBitMask(uint8_t pin){
+	if(pin < 8) return _BV(pin);
+	if(pin < 14) return _BV(pin - 8);
+	if(pin < NUM_DIGITAL_PINS) return _BV(pin - 14);
+	return 0;
+}
+
+volatile uint8_t* portOutputRegister(uint8_t port){
+	switch(port){
+		case PB: return &PORTB;
+		case PC: return &PORTC;
+		case PD: return &PORTD;
+		default: return 0;
+	}
+}
+
+volatile uint8_t* portInputRegister(uint8_t port){
+	switch(port){
+		case PB: return &PINB;
+		case PC: return &PINC;
+		case PD: return &PIND;
+		default: return 0;
+	}
+}
+
+volatile uint8_t* portModeRegister(uint8_t port){
+	switch(port){
+		case PB: return &DDRB;
+		case PC: return &DDRC;
+		case PD: return &DDRD;
+		default: return 0;
+	}
+}
+
+void pinMode(uint8_t pin, uint8_t mode){
+	uint8_t mask;
+	volatile uint8_t *ddr;
+	volatile uint8_t *port = portOf(pin, mask, ddr);
+	if(!port) return;
+	CapADCSim::advance(40);
+	if(mode == OUTPUT){
+		*ddr |= mask;
+	} else {
+		*ddr &= ~mask;
+		if(mode == INPUT_PULLUP) *port |= mask;
+		else *port &= ~mask;
+	}
+}
+
+void digitalWrite(uint8_t pin, uint8_t value){
+	uint8_t mask;
+	volatile uint8_t *ddr;
+	volatile uint8_t *port = portOf(pin, mask, ddr);
+	if(!port) return;
+	CapADCSim::advance(50);
+	if(value) *port |= mask;
+	else *port &= ~mask;
+}
+
+int digitalRead(uint8_t pin){
+	uint8_t mask;
+	volatile uint8_t *ddr;
+	volatile uint8_t *port = portOf(pin, mask, ddr);
+	if(!port) return LOW;
+	CapADCSim::advance(50);
+	return (*portInputRegister(digitalPinToPort(pin)) & mask)?HIGH:LOW;
+}
+
+unsigned long millis(){
+	CapADCSim::advance(20);
+	return now / (F_CPU / 1000);
+}
+
+unsigned long micros(){
+	CapADCSim::advance(20);
+	return now / clockCyclesPerMicrosecond();
+}
+
+void delay(unsigned long ms){
+	CapADCSim::run(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us){
+	CapADCSim::advance(us * clockCyclesPerMicrosecond());
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size){
+	size_t n = 0;
+	while(size--){
+		n += write(*buffer++);
+	}
+	return n;
+}
+
+size_t Print::print(long value, int base){
+	if(value < 0 && base == 10) return print('-') + print((unsigned long)-value, base);
+	return print((unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base){
+	char buffer[33];
+	char *c = buffer + sizeof(buffer) - 1;
+	*c = 0;
+	if(base < 2) base = 10;
+	do{
+		uint8_t digit = value % base;
+		*--c = (digit < 10)?('0' + digit):('A' + digit - 10);
+		value /= base;
+	}while(value);
+	return write(c);
+}
+
+size_t Print::print(double value, int digits){
+	char buffer[48];
+	snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+	return write(buffer);
+}
+
+int HardwareSerial::availableForWrite(){
+	return 63;
+}
+
+size_t HardwareSerial::write(uint8_t data){
+	serialOutput.push_back((char)data);
+	return 1;
+}
+
+uint8_t EEPROMClass::read(int address){
+	CapADCSim::advance(4);
+	return eeprom[address & 0x3FF];
+}
+
+void EEPROMClass::write(int address, uint8_t value){
+	// An EEPROM write takes 3.3ms.
+	CapADCSim::run(3300);
+	eeprom[address & 0x3FF] = value;
+}
+
+void EEPROMClass::update(int address, uint8_t value){
+	if(read(address) != value) write(address, value);
+}
@@ -0,0 +1,79 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Host simulator of an ATmega328P running the library.
+//
+// The simulator models, at register level, what the library touches:
+// - the ADC: mux, reference, prescaler, left adjust, sample and hold timing, 13 clock
+//   conversions (25 for the first one), flags and interrupt;
+// - the ports: electrodes are charged and discharged through the pin drivers, and share
+//   their charge with the sample and hold capacitor through the mux resistance;
+// - timer 2 in normal and CTC mode, with its compare A interrupt;
+// - timer 1 as a cycle counter, in normal mode, stopped at reset;
+// - SREG, interrupt dispatch and the ADC noise reduction sleep mode.
+//
+// Electrodes are capacitors on the analog pins. A finger adds capacitance to its electrode.
+// Mutual capacitance is a capacitor between a digital pin and an electrode: each edge of
+// the digital pin injects charge in the electrode while it floats.
+// Conversions get a gaussian noise and an optional mains interference.
+// An optional clock noise grows with the ADC clock above the rated one, in LSB per MHz.
+// An optional digital noise is added to conversions during which the CPU was awake at some point,
+// not in the ADC noise reduction sleep mode.
+//
+// Everything runs in one thread, on a virtual clock counted in CPU cycles.
+// Each register access costs one cycle, delays and busy waits let the clock run,
+// and interrupts are taken between two accesses, as on the target.
+// Code waiting on the library without touching a register (e.g. polling a scanner)
+// must let the time pass itself, with CapADCSim::run() or delay().
+
+#ifndef CAP_ADC_SIM_H
+#define CAP_ADC_SIM_H
+
+// Standard headers first: the Arduino min() and max() macros break them.
+#include <string>
+#include <Arduino.h>
+
+namespace CapADCSim{
+	// Power-on state: registers, clock, electrodes, EEPROM, serial output.
+	void reset(uint32_t seed = 1);
+
+	// Virtual clock.
+	uint64_t cycles();
+	void advance(uint32_t cycles);
+	void run(uint32_t us);
+
+	// Analog front end. Capacitances are in pF, resistances in ohms.
+	void setElectrode(uint8_t pin, float capacitance, float resistance = 0);
+	void setTouch(uint8_t pin, float capacitance);
+	void setCoupling(uint8_t drivePin, uint8_t pin, float capacitance);
+	void setNoise(float lsb);
+	void setClockNoise(float lsbPerMHz, uint32_t rated = 1000000);
+	void setDigitalNoise(float lsb);
+	void setMains(float volts, float hertz = 50);
+
+	float getVoltage(uint8_t pin);
+
+	// Counters.
+	uint32_t getConversions();
+	uint32_t getInterrupts();
+
+	// Everything written to Serial since the last reset or clear.
+	std::string& serial();
+}
+
+#endif
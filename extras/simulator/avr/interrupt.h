@@ -0,0 +1,33 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Simulated interrupts.
+// Vectors are plain functions, called by the simulator when their flag and enable bits
+// are set and SREG_I is set, lowest vector first, one at a time as on the target.
+
+#ifndef CAP_ADC_SIM_AVR_INTERRUPT_H
+#define CAP_ADC_SIM_AVR_INTERRUPT_H
+
+#include <avr/io.h>
+
+#define ISR(vector, ...)			extern "C" void vector(void); void vector(void)
+
+void cli();
+void sei();
+
+#endif
@@ -0,0 +1,164 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Simulated ATmega328P registers.
+// ADC, timers 1 and 2, SREG and sleep registers are objects: each access costs one cycle of
+// the virtual clock, and writes have the hardware side effects (conversion start,
+// flags cleared by writing one, interrupts enabled...).
+// Timer 1 only counts, in normal mode, for cycle counts: it has no compare nor interrupt.
+// Port registers are plain memory, read by the simulator each time the clock advances.
+
+#ifndef CAP_ADC_SIM_AVR_IO_H
+#define CAP_ADC_SIM_AVR_IO_H
+
+#include <stdint.h>
+
+#define __AVR__
+#define __AVR_ATmega328P__
+
+#ifndef F_CPU
+#define F_CPU						16000000UL
+#endif
+
+#define _BV(bit)					(1 << (bit))
+
+class CapADCSimRegister{
+public:
+	explicit CapADCSimRegister(uint8_t id): _id(id){}
+
+	operator uint8_t() const;
+	CapADCSimRegister& operator=(uint8_t value);
+	CapADCSimRegister& operator=(const CapADCSimRegister &other){return *this = (uint8_t)other;}
+	CapADCSimRegister& operator|=(uint8_t value){return *this = (uint8_t)(*this | value);}
+	CapADCSimRegister& operator&=(uint8_t value){return *this = (uint8_t)(*this & value);}
+	CapADCSimRegister& operator^=(uint8_t value){return *this = (uint8_t)(*this ^ value);}
+
+private:
+	uint8_t _id;
+};
+
+// 16 bits register, accessed in two cycles as through the AVR TEMP register.
+class CapADCSimRegister16{
+public:
+	explicit CapADCSimRegister16(uint8_t id): _id(id){}
+
+	operator uint16_t() const;
+	CapADCSimRegister16& operator=(uint16_t value);
+
+private:
+	uint8_t _id;
+};
+
+extern CapADCSimRegister SREG;
+extern CapADCSimRegister SMCR;
+extern CapADCSimRegister ADMUX;
+extern CapADCSimRegister ADCSRA;
+extern CapADCSimRegister ADCSRB;
+extern CapADCSimRegister ADCL;
+extern CapADCSimRegister ADCH;
+extern CapADCSimRegister TCCR1A;
+extern CapADCSimRegister TCCR1B;
+extern CapADCSimRegister16 TCNT1;
+extern CapADCSimRegister TIFR1;
+extern CapADCSimRegister TCCR2A;
+extern CapADCSimRegister TCCR2B;
+extern CapADCSimRegister TCNT2;
+extern CapADCSimRegister OCR2A;
+extern CapADCSimRegister TIMSK2;
+extern CapADCSimRegister TIFR2;
+
+extern volatile uint8_t PORTB, DDRB, PINB;
+extern volatile uint8_t PORTC, DDRC, PINC;
+extern volatile uint8_t PORTD, DDRD, PIND;
+extern volatile uint8_t DIDR0;
+
+// SREG
+#define SREG_I						7
+
+// SMCR
+#define SM2							3
+#define SM1							2
+#define SM0							1
+#define SE							0
+
+// ADMUX
+#define REFS1						7
+#define REFS0						6
+#define ADLAR						5
+#define MUX3						3
+#define MUX2						2
+#define MUX1						1
+#define MUX0						0
+
+// ADCSRA
+#define ADEN						7
+#define ADSC						6
+#define ADATE						5
+#define ADIF						4
+#define ADIE						3
+#define ADPS2						2
+#define ADPS1						1
+#define ADPS0						0
+
+// ADCSRB
+#define ACME						6
+#define ADTS2						2
+#define ADTS1						1
+#define ADTS0						0
+
+// TCCR1B
+#define WGM13						4
+#define WGM12						3
+#define CS12						2
+#define CS11						1
+#define CS10						0
+
+// TIFR1
+#define TOV1						0
+
+// TCCR2A
+#define COM2A1						7
+#define COM2A0						6
+#define COM2B1						5
+#define COM2B0						4
+#define WGM21						1
+#define WGM20						0
+
+// TCCR2B
+#define FOC2A						7
+#define FOC2B						6
+#define WGM22						3
+#define CS22						2
+#define CS21						1
+#define CS20						0
+
+// TIMSK2
+#define OCIE2B						2
+#define OCIE2A						1
+#define TOIE2						0
+
+// TIFR2
+#define OCF2B						2
+#define OCF2A						1
+#define TOV2						0
+
+// Interrupt vectors, numbered as on the ATmega328P.
+#define TIMER2_COMPA_vect			__vector_7
+#define ADC_vect					__vector_21
+
+#endif
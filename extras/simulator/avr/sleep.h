@@ -0,0 +1,39 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Simulated sleep modes.
+// sleep_cpu() lets the virtual clock run until an interrupt is taken.
+// As on the target, sleeping in ADC noise reduction mode starts a conversion
+// when the ADC is enabled and idle.
+
+#ifndef CAP_ADC_SIM_AVR_SLEEP_H
+#define CAP_ADC_SIM_AVR_SLEEP_H
+
+#include <avr/io.h>
+
+#define SLEEP_MODE_IDLE				(0)
+#define SLEEP_MODE_ADC				_BV(SM0)
+#define SLEEP_MODE_PWR_DOWN			_BV(SM1)
+
+#define set_sleep_mode(mode)		(SMCR = (SMCR & ~(_BV(SM0) | _BV(SM1) | _BV(SM2))) | (mode))
+#define sleep_enable()				(SMCR |= _BV(SE))
+#define sleep_disable()				(SMCR &= ~_BV(SE))
+
+void sleep_cpu();
+
+#endif
@@ -0,0 +1,54 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// A touch button on A0, with A1 as friend pin, run on the simulator.
+// A finger adds 5pF to the 20pF electrode from 2s to 3s.
+// Prints one CSV line every 20ms: time in ms, delta, touched, conversions so far.
+// Usage: simulate_pin [noise in LSB] [mains interference in V]
+
+#include "CapADCSim.h"
+#include "CapacitiveADCPin.h"
+
+#include <stdio.h>
+
+int main(int argc, char **argv){
+	CapADCSim::reset();
+	CapADCSim::setElectrode(A0, 20);
+	if(argc > 1) CapADCSim::setNoise(atof(argv[1]));
+	if(argc > 2) CapADCSim::setMains(atof(argv[2]));
+
+	CapADCPin pin;
+	pin.init(A0, A1);
+	pin.tuneBaseline();
+	printf("# baseline %u at %lums\n", pin.getBaseline(), millis());
+
+	printf("ms,delta,touched,conversions\n");
+	uint32_t next = millis();
+	while(millis() < 5000){
+		uint32_t now = millis();
+		CapADCSim::setTouch(A0, (now >= 2000 && now < 3000)?5:0);
+		pin.update();
+		if(now >= next){
+			next += 20;
+			printf("%lu,%d,%d,%lu\n", (unsigned long)now, pin.getDelta(), pin.isTouched(),
+					(unsigned long)CapADCSim::getConversions());
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,85 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Throughput of CapADCRing between two threads: the producer emulates the scanner interrupt,
+// pushing one sample per read, the consumer drains them in batches as CapADCScanner::poll() does.
+// The consumer checks every sample arrives, in order.
+// Usage: bench_ring [samples]
+
+// On the host, the CPU may reorder memory accesses: the barrier must be a fence.
+#include <atomic>
+#define CAP_ADC_BARRIER()	std::atomic_thread_fence(std::memory_order_seq_cst)
+
+#include <chrono>
+#include <thread>
+
+#include "CapADCSim.h"
+#include "CapacitiveADCScanner.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef CapADCRing<CapADCSample_t, CAP_ADC_SCAN_RING_SIZE> Ring;
+
+static Ring ring;
+
+static uint32_t fullCount = 0;
+
+static void producer(uint32_t samples){
+	CapADCSample_t sample = {0, 0};
+	for(uint32_t i = 0; i < samples; ++i){
+		sample.index = i % MAX_SCAN_CHANNEL;
+		sample.value = i & 0x7fff;
+		// The scanner pauses when the ring is full, the loop resumes it: spin instead.
+		while(!ring.push(sample)){
+			++fullCount;
+			std::this_thread::yield();
+		}
+	}
+}
+
+int main(int argc, char **argv){
+	uint32_t samples = (argc > 1)?strtoul(argv[1], 0, 0):4000000UL;
+
+	auto start = std::chrono::steady_clock::now();
+	std::thread thread(producer, samples);
+
+	uint32_t received = 0, errors = 0, batches = 0;
+	CapADCSample_t sample;
+	while(received < samples){
+		bool batch = false;
+		while(ring.pop(sample)){
+			if(sample.index != received % MAX_SCAN_CHANNEL || sample.value != (int16_t)(received & 0x7fff)){
+				++errors;
+			}
+			++received;
+			batch = true;
+		}
+		if(batch) ++batches;
+		else std::this_thread::yield();
+	}
+
+	thread.join();
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	printf("samples,errors,batches,full,seconds,samples_per_s\n");
+	printf("%lu,%lu,%lu,%lu,%.3f,%.0f\n", (unsigned long)received, (unsigned long)errors,
+			(unsigned long)batches, (unsigned long)fullCount, seconds, received / seconds);
+
+	return errors?1:0;
+}
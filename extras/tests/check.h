@@ -0,0 +1,54 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Minimal checks for the host tests: no framework, a failed check prints its line and
+// the program exits non zero at the end.
+
+#ifndef CAP_ADC_CHECK_H
+#define CAP_ADC_CHECK_H
+
+#include <stdio.h>
+
+static unsigned checkFailures = 0;
+static unsigned checkCount = 0;
+
+#define CHECK(condition)	do{ \
+	++checkCount; \
+	if(!(condition)){ \
+		++checkFailures; \
+		printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+	} \
+}while(0)
+
+#define CHECK_EQUAL(value, expected)	do{ \
+	++checkCount; \
+	long long checkValue = (long long)(value), checkExpected = (long long)(expected); \
+	if(checkValue != checkExpected){ \
+		++checkFailures; \
+		printf("%s:%d: check failed: %s is %lld, expected %lld\n", __FILE__, __LINE__, \
+				#value, checkValue, checkExpected); \
+	} \
+}while(0)
+
+// Return value of main().
+static int checkReport(const char *name){
+	printf("%s: %u checks, %u failed\n", name, checkCount, checkFailures);
+	return checkFailures?1:0;
+}
+
+#endif
@@ -0,0 +1,63 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+
+#include "file_eeprom.h"
+
+static FILE *file = 0;
+static uint32_t writes = 0;
+
+// Open, or create, the file backing the EEPROM.
+bool fileEEPROMOpen(const char *path){
+	fileEEPROMClose();
+	file = fopen(path, "r+b");
+	if(!file) file = fopen(path, "w+b");
+	return file != 0;
+}
+
+void fileEEPROMClose(){
+	if(file) fclose(file);
+	file = 0;
+}
+
+uint8_t fileEEPROMRead(uint16_t address){
+	if(!file || fseek(file, address, SEEK_SET) != 0) return 0xFF;
+
+	int value = fgetc(file);
+	return (value == EOF)?0xFF:value;
+}
+
+// Written as EEPROM.update() does: only changed bytes. The file grows erased up to address.
+void fileEEPROMWrite(uint16_t address, uint8_t value){
+	if(!file || fileEEPROMRead(address) == value) return;
+
+	fseek(file, 0, SEEK_END);
+	for(long end = ftell(file); end < address; ++end){
+		fputc(0xFF, file);
+	}
+	fseek(file, address, SEEK_SET);
+	fputc(value, file);
+	fflush(file);
+	++writes;
+}
+
+// Number of bytes actually written since the start.
+uint32_t fileEEPROMWrites(){
+	return writes;
+}
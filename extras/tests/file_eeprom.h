@@ -0,0 +1,38 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// File backed EEPROM stand-in, for the library calibration records.
+// Built with -include file_eeprom.h, the library reads and writes the file instead of the
+// simulated EEPROM, and a record survives the program, as it survives a power cycle on the target.
+// Bytes past the end of the file read as erased, 0xFF.
+
+#ifndef CAP_ADC_FILE_EEPROM_H
+#define CAP_ADC_FILE_EEPROM_H
+
+#include <stdint.h>
+
+bool fileEEPROMOpen(const char *path);
+void fileEEPROMClose();
+uint8_t fileEEPROMRead(uint16_t address);
+void fileEEPROMWrite(uint16_t address, uint8_t value);
+uint32_t fileEEPROMWrites();
+
+#define CAP_ADC_EEPROM_READ(address)			fileEEPROMRead(address)
+#define CAP_ADC_EEPROM_WRITE(address, value)	fileEEPROMWrite(address, value)
+
+#endif
@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+#
+# This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+# Copyright (C) 2017  Pierre-Loup Martin
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# End to end test of the telemetry stream: frames recorded on the simulator by test_telemetry
+# go through a pseudo-terminal to capadc_telemetry.py, as from a board on a serial port,
+# with a corrupted frame and noise on the line. The CSV decoded must be the one expected.
+#
+# usage: telemetry_pty.py TEST_TELEMETRY DECODER
+
+import os
+import subprocess
+import sys
+import tempfile
+import termios
+import time
+
+FRAME_SIZE = 14
+CORRUPTED = 100
+TIMEOUT = 20
+
+
+def fail(message):
+	sys.exit('telemetry_pty: ' + message)
+
+
+def lines(path):
+	with open(path) as f:
+		return f.read().splitlines()
+
+
+def run(program, decoder, directory):
+	stream_path = os.path.join(directory, 'stream.bin')
+	expected_path = os.path.join(directory, 'expected.csv')
+	output_path = os.path.join(directory, 'decoded.csv')
+
+	if subprocess.call([program, stream_path, expected_path]) != 0:
+		fail(program + ' failed')
+
+	with open(stream_path, 'rb') as f:
+		stream = bytearray(f.read())
+	expected = lines(expected_path)
+
+	# A frame with a bad checksum is skipped, the next ones are decoded again,
+	# and so are the ones after bytes of noise.
+	stream[CORRUPTED * FRAME_SIZE + 5] ^= 0x10
+	del expected[1 + CORRUPTED]
+	middle = len(stream) // FRAME_SIZE // 2 * FRAME_SIZE
+	stream[middle:middle] = b'\x00\x13\x5a\xff'
+	# The decoder times frames from the first one: noise before it doesn't count.
+	stream[0:0] = b'\x0d\x0a'
+
+	master, slave = os.openpty()
+	decoding = subprocess.Popen([sys.executable, decoder, os.ttyname(slave), '-o', output_path])
+
+	# The decoder sets the port raw itself: wait for it, or the line discipline would change bytes.
+	deadline = time.time() + TIMEOUT
+	while termios.tcgetattr(slave)[3] & (termios.ICANON | termios.ECHO):
+		if decoding.poll() is not None or time.time() > deadline:
+			fail('decoder did not set the port to raw mode')
+		time.sleep(0.01)
+
+	for start in range(0, len(stream), 100):
+		os.write(master, bytes(stream[start:start + 100]))
+
+	# Closing the line before the decoder read everything would lose frames.
+	while not os.path.exists(output_path) or len(lines(output_path)) < len(expected):
+		if decoding.poll() is not None or time.time() > deadline:
+			break
+		time.sleep(0.05)
+
+	os.close(slave)
+	os.close(master)
+	try:
+		decoding.wait(TIMEOUT)
+	except subprocess.TimeoutExpired:
+		decoding.kill()
+		fail('decoder did not stop once the line was closed')
+
+	decoded = lines(output_path)
+	for number, (line, reference) in enumerate(zip(decoded, expected)):
+		if line != reference:
+			fail('line %d is "%s", expected "%s"' % (number + 1, line, reference))
+	if len(decoded) != len(expected):
+		fail('%d lines decoded, expected %d' % (len(decoded), len(expected)))
+
+	print('telemetry_pty: %d frames decoded through a pseudo-terminal' % (len(decoded) - 1))
+
+
+def main():
+	with tempfile.TemporaryDirectory(prefix='telemetry_pty') as directory:
+		run(sys.argv[1], sys.argv[2], directory)
+
+
+if __name__ == '__main__':
+	main()
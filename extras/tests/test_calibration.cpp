@@ -0,0 +1,178 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Tests of calibration records, saved to a file backed EEPROM: a record restored after a power cycle,
+// and records refused when corrupted, of another version or size, or when the electrode drifted,
+// which leaves the settings in place. A matrix record holds every key.
+
+#include <stdio.h>
+
+#include "check.h"
+#include "CapADCSim.h"
+#include "CapacitiveADCPin.h"
+#include "CapacitiveADCMatrix.h"
+
+static const char *path = "test_calibration.eeprom";
+static const uint16_t address = 16;
+
+// Power the board up: registers and clock reset, a new pin, the EEPROM file as it was left.
+static void powerUp(CapADCPin& pin){
+	CapADCSim::reset();
+	CapADCSim::setElectrode(A0, 20);
+	CHECK(fileEEPROMOpen(path));
+	pin.init(A0, A1);
+}
+
+// Save a tuned pin, then restore it after a power cycle.
+static void testRoundTrip(){
+	CapADCPin saved;
+	powerUp(saved);
+	saved.tuneBaseline(100);
+	saved.setTouchThreshold(123);
+	saved.setReleaseThreshold(77);
+
+	uint16_t size = saved.getCalibrationSize();
+	CHECK_EQUAL(saved.saveCalibration(address), size);
+	CHECK_EQUAL(fileEEPROMRead(address), 0xCA);
+	CHECK_EQUAL(fileEEPROMRead(address + 1), CAP_ADC_STORE_VERSION);
+	CHECK_EQUAL(fileEEPROMRead(address + 2) | (fileEEPROMRead(address + 3) << 8), size);
+
+	// Saving again changes nothing: no byte is written.
+	uint32_t writes = fileEEPROMWrites();
+	saved.saveCalibration(address);
+	CHECK_EQUAL(fileEEPROMWrites(), writes);
+
+	CapADCPin restored;
+	powerUp(restored);
+	CHECK(restored.restoreCalibration(address));
+	CHECK_EQUAL(restored.getBaseline(), saved.getBaseline());
+	CHECK_EQUAL(restored.getLocalSettings().touchThreshold, 123);
+	CHECK_EQUAL(restored.getLocalSettings().releaseThreshold, 77);
+}
+
+// Change one byte of the saved record, and check the restore is refused without changing anything.
+static void checkRefused(uint16_t offset, uint8_t value){
+	uint8_t previous = fileEEPROMRead(address + offset);
+	fileEEPROMWrite(address + offset, value);
+
+	CapADCPin pin;
+	powerUp(pin);
+	pin.setTouchThreshold(55);
+	CHECK(!pin.restoreCalibration(address));
+	CHECK_EQUAL(pin.getLocalSettings().touchThreshold, 55);
+
+	fileEEPROMWrite(address + offset, previous);
+}
+
+// A corrupted byte fails the CRC, another version or size fails the header.
+static void testRefused(){
+	CapADCPin pin;
+	powerUp(pin);
+	uint16_t size = pin.getCalibrationSize();
+
+	// A byte of the baseline, then of the CRC itself.
+	checkRefused(size - 2 - sizeof(CapADCStoredChannel_t), fileEEPROMRead(address + size - 2 - sizeof(CapADCStoredChannel_t)) ^ 0x01);
+	checkRefused(size - 1, fileEEPROMRead(address + size - 1) ^ 0x80);
+	checkRefused(1, CAP_ADC_STORE_VERSION - 1);
+	// A record 256 bytes longer, that a size on 8 bits would take.
+	checkRefused(3, (size >> 8) + 1);
+
+	// The record is untouched.
+	powerUp(pin);
+	CHECK(pin.restoreCalibration(address));
+}
+
+// The electrode changed since the record was saved: the restore is refused,
+// and the global settings in use are kept, not the ones of the record.
+static void testDrift(){
+	CapADCPin pin;
+	powerUp(pin);
+	CapADCSetGlobal_t settings = pin.getGlobalSettings();
+	settings.samples = settings.samples + 1;
+	settings.debounce = settings.debounce + 3;
+	pin.applyGlobalSettings(settings);
+
+	CapADCSim::setElectrode(A0, 30);
+	CHECK(!pin.restoreCalibration(address));
+	CHECK_EQUAL(pin.getGlobalSettings().samples, settings.samples);
+	CHECK_EQUAL(pin.getGlobalSettings().debounce, settings.debounce);
+
+	CapADCSim::setElectrode(A0, 20);
+	CHECK(pin.restoreCalibration(address));
+	CHECK_EQUAL(pin.getGlobalSettings().samples, settings.samples - 1);
+}
+
+// Power the board up with a 2 x 2 keypad.
+static void powerUp(CapADCMatrix<2, 2>& keypad){
+	static const uint8_t rows[2] = {2, 3};
+	static const uint8_t cols[2] = {A0, A1};
+
+	CapADCSim::reset();
+	CapADCSim::setElectrode(A0, 20);
+	CapADCSim::setElectrode(A1, 20);
+	CapADCSim::setCoupling(2, A0, 2);
+	CapADCSim::setCoupling(2, A1, 2);
+	CapADCSim::setCoupling(3, A0, 2);
+	CapADCSim::setCoupling(3, A1, 1.5);
+	CHECK(fileEEPROMOpen(path));
+	keypad.init(rows, cols);
+}
+
+// Every key of a matrix gets its baseline back, and a key whose coupling changed refuses the record.
+static void testMatrix(){
+	static const uint16_t matrixAddress = 256;
+
+	CapADCMatrix<2, 2> saved;
+	powerUp(saved);
+	saved.tuneBaseline(100);
+	CHECK_EQUAL(saved.getCalibrationSize(), 5 + sizeof(CapADCSetGlobal_t) + sizeof(CapADCSetLocal_t)
+				+ 4 * sizeof(CapADCStoredChannel_t) + 2);
+	saved.saveCalibration(matrixAddress);
+
+	CapADCMatrix<2, 2> restored;
+	powerUp(restored);
+	CHECK(restored.restoreCalibration(matrixAddress));
+	for(uint8_t r = 0; r < 2; ++r){
+		for(uint8_t c = 0; c < 2; ++c){
+			CHECK(restored.getBaseline(r, c) > 100);
+			CHECK_EQUAL(restored.getBaseline(r, c), saved.getBaseline(r, c));
+		}
+	}
+	uint32_t start = millis();
+	while(millis() - start < 50) restored.update();
+	CHECK_EQUAL(restored.getKey(), CapADCMatrixBase::NoKey);
+
+	CapADCMatrix<2, 2> drifted;
+	powerUp(drifted);
+	CapADCSim::setCoupling(3, A1, 0.5);
+	CHECK(!drifted.restoreCalibration(matrixAddress));
+	CHECK_EQUAL(drifted.getBaseline(0, 0), 0);
+}
+
+int main(){
+	remove(path);
+
+	testRoundTrip();
+	testRefused();
+	testDrift();
+	testMatrix();
+
+	fileEEPROMClose();
+	remove(path);
+	return checkReport("test_calibration");
+}
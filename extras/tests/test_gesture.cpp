@@ -0,0 +1,102 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Tests of CapADCGesture fed with a slider on the simulator: taps at both ends and a swipe,
+// and a wheel turning for long.
+
+#include "check.h"
+#include "CapADCSim.h"
+#include "CapacitiveADCGesture.h"
+
+static CapADCSlider<3> slider;
+static CapADCGesture gesture;
+
+static const uint8_t pins[3] = {A0, A1, A2};
+
+// Update the slider and the gesture for ms, with a finger on pin, or none if pin is 0.
+// Returns the last gesture recognized.
+static uint8_t touchFor(uint8_t pin, uint32_t ms){
+	for(uint8_t i = 0; i < 3; ++i){
+		CapADCSim::setTouch(pins[i], (pins[i] == pin)?10:0);
+	}
+
+	uint8_t last = CapADCGesture::None;
+	uint32_t start = millis();
+	while(millis() - start < ms){
+		slider.update();
+		uint8_t value = gesture.update(slider);
+		if(value != CapADCGesture::None) last = value;
+	}
+
+	return last;
+}
+
+// Two taps at opposite ends are two taps: the second touch doesn't start from the first position.
+static void testTaps(){
+	CHECK_EQUAL(touchFor(A0, 100), CapADCGesture::None);
+	CHECK(slider.getPosition() > 64);
+	CHECK_EQUAL(touchFor(0, 500), CapADCGesture::Tap);
+
+	CHECK_EQUAL(touchFor(A2, 100), CapADCGesture::None);
+	CHECK(slider.getPosition() < -64);
+	CHECK_EQUAL(touchFor(0, 500), CapADCGesture::Tap);
+	CHECK(abs(gesture.getTravel()) <= 8);
+}
+
+// A finger moving from one end to the other is a swipe toward negative positions.
+static void testSwipe(){
+	touchFor(A0, 60);
+	touchFor(A1, 60);
+	touchFor(A2, 60);
+	CHECK_EQUAL(touchFor(0, 100), CapADCGesture::SwipeDown);
+	CHECK(gesture.getVelocity() < 0);
+}
+
+// A wheel turned 300 times travels further than 16 bits hold: the swipe keeps its direction.
+static void testLongTravel(){
+	CapADCGesture wheel;
+	uint32_t now = 1000;
+	int8_t position = 0;
+	wheel.update(true, position, now);
+	for(uint16_t i = 0; i < 300 * 16; ++i){
+		position += 16;
+		wheel.update(true, position, ++now);
+	}
+
+	CHECK_EQUAL(wheel.getTravel(), 300L * 256);
+	CHECK_EQUAL(wheel.update(false, position, now + 1), CapADCGesture::SwipeUp);
+	CHECK_EQUAL(wheel.getVelocity(), 16000);
+}
+
+int main(){
+	CapADCSim::reset();
+	for(uint8_t i = 0; i < 3; ++i){
+		CapADCSim::setElectrode(pins[i], 20);
+	}
+
+	slider.init(A0, A1, A2);
+	slider.tuneBaseline();
+	slider.setTouchThreshold(100);
+	slider.setReleaseThreshold(60);
+
+	testTaps();
+	testSwipe();
+	testLongTravel();
+
+	return checkReport("test_gesture");
+}
@@ -0,0 +1,148 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Tests of CapADCMatrix on the simulator: mutual reads, baselines and touch of a 2 x 2 keypad,
+// and scans split over updates by a budget.
+
+#include "check.h"
+#include "CapADCSim.h"
+#include "CapacitiveADCMatrix.h"
+
+static const uint8_t rows[2] = {2, 3};
+static const uint8_t cols[2] = {A0, A1};
+
+static CapADCMatrix<2, 2> keypad;
+
+static void updateFor(uint32_t ms){
+	uint32_t start = millis();
+	while(millis() - start < ms) keypad.update();
+}
+
+// Mutual reads drop with the coupling, and are positive.
+static void testRead(){
+	CapADCChannel channel;
+	channel.init(A0, A1);
+	channel.setDrivePin(2);
+
+	int16_t coupled = channel.read();
+	CapADCSim::setCoupling(2, A0, 1);
+	int16_t touched = channel.read();
+	CapADCSim::setCoupling(2, A0, 2);
+
+	CHECK(touched > 0);
+	CHECK(coupled > touched + 20);
+
+	channel.setResolution(8);
+	CHECK(channel.read() > 0);
+	channel.setDrivePin(CapADCChannel::NoDrive);
+}
+
+// Baselines are the coupling of each key, far from the 16 bits wrap.
+static void testBaseline(){
+	keypad.init(rows, cols);
+	keypad.tuneBaseline();
+
+	for(uint8_t r = 0; r < 2; ++r){
+		for(uint8_t c = 0; c < 2; ++c){
+			CHECK(keypad.getBaseline(r, c) > 100);
+			CHECK(keypad.getBaseline(r, c) < 0x8000);
+		}
+	}
+	// The weaker coupling reads lower.
+	CHECK(keypad.getBaseline(1, 1) < keypad.getBaseline(0, 0));
+}
+
+// A finger on a key lowers its coupling: only that key is touched.
+// The neighbour keys see some crosstalk, below the threshold.
+static void testTouch(){
+	keypad.setTouchThreshold(100);
+	keypad.setReleaseThreshold(60);
+	updateFor(100);
+	CHECK_EQUAL(keypad.getKey(), CapADCMatrixBase::NoKey);
+
+	CapADCSim::setCoupling(3, A0, 1);
+	updateFor(100);
+	CHECK_EQUAL(keypad.getKey(), 2);
+	CHECK(keypad.isTouched(1, 0));
+	CHECK(!keypad.isTouched(0, 0));
+	CHECK(!keypad.isTouched(1, 1));
+	CHECK(keypad.getDelta(1, 0) > 0);
+
+	CapADCSim::setCoupling(3, A0, 2);
+	updateFor(100);
+	CHECK_EQUAL(keypad.getKey(), CapADCMatrixBase::NoKey);
+}
+
+// With a budget, an update reads the keys that fit in it, and the next ones go on from there.
+// Touches are still seen, and told just touched once.
+static void testBudget(){
+	keypad.update();
+	uint32_t full = keypad.getScanTime();
+	uint32_t key = full / 4;
+
+	keypad.setScanBudget(key * 5 / 2);
+	uint32_t longest = 0;
+	for(uint8_t i = 0; i < 20; ++i){
+		uint32_t start = micros();
+		keypad.update();
+		uint32_t length = micros() - start;
+		if(longest < length) longest = length;
+	}
+	CHECK(longest <= keypad.getScanBudget());
+	CHECK(longest > key);
+	// Two keys per update: a full scan spans two updates.
+	CHECK(keypad.getScanTime() > full);
+
+	CapADCSim::setCoupling(3, A0, 1);
+	uint16_t justTouched = 0;
+	uint32_t start = millis();
+	while(millis() - start < 100){
+		keypad.update();
+		if(keypad.isJustTouched(1, 0)) ++justTouched;
+	}
+	CHECK_EQUAL(keypad.getKey(), 2);
+	CHECK_EQUAL(justTouched, 1);
+
+	CapADCSim::setCoupling(3, A0, 2);
+	updateFor(100);
+	CHECK_EQUAL(keypad.getKey(), CapADCMatrixBase::NoKey);
+
+	// A budget shorter than a key read still reads one key.
+	keypad.setScanBudget(1);
+	uint32_t before = CapADCSim::getConversions();
+	keypad.update();
+	CHECK(CapADCSim::getConversions() > before);
+	keypad.setScanBudget(0);
+}
+
+int main(){
+	CapADCSim::reset();
+	CapADCSim::setElectrode(A0, 20);
+	CapADCSim::setElectrode(A1, 20);
+	CapADCSim::setCoupling(2, A0, 2);
+	CapADCSim::setCoupling(2, A1, 2);
+	CapADCSim::setCoupling(3, A0, 2);
+	CapADCSim::setCoupling(3, A1, 1.5);
+
+	testRead();
+	testBaseline();
+	testTouch();
+	testBudget();
+
+	return checkReport("test_matrix");
+}
@@ -0,0 +1,79 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Tests of CapADCChannel::calibratePrescaler() on the simulator, with a noise growing
+// with the ADC clock: the default prescalers are reachable, and faster clocks are left when too noisy.
+
+#include "check.h"
+#include "CapADCSim.h"
+#include "CapacitiveADCChannel.h"
+
+static CapADCChannel channel;
+
+// Calibrate a fresh channel at a resolution, with a clock noise.
+static uint8_t calibrate(uint8_t bits, float clockNoise){
+	CapADCSim::reset();
+	CapADCSim::setClockNoise(clockNoise);
+	channel.init(A0, A1);
+	channel.setResolution(bits);
+	return channel.calibratePrescaler(10);
+}
+
+// Peak to peak noise of reads at a prescaler.
+static int16_t noiseAt(uint8_t prescaler){
+	channel.setPrescaler(prescaler);
+	channel.read();
+
+	int16_t min = 0x7FFF;
+	int16_t max = -0x7FFF;
+	for(uint8_t i = 0; i < 32; ++i){
+		int16_t value = channel.read();
+		if(value < min) min = value;
+		if(value > max) max = value;
+	}
+	return max - min;
+}
+
+// Without clock noise, calibration keeps the default prescaler of each resolution.
+static void testDefaults(){
+	CHECK_EQUAL(calibrate(8, 0), 0b010);
+	CHECK_EQUAL(channel.getPrescaler(), 0b010);
+	CHECK_EQUAL(calibrate(10, 0), 0b011);
+	CHECK_EQUAL(channel.getPrescaler(), 0b011);
+}
+
+// With a clock noise, the fastest clocks are too noisy: calibration slows down,
+// and keeps a prescaler quieter than the ones it left.
+static void testNoisyClock(){
+	static const uint8_t bits[2] = {8, 10};
+
+	for(uint8_t i = 0; i < 2; ++i){
+		uint8_t prescaler = calibrate(bits[i], 3);
+		uint8_t first = (bits[i] == 8)?0b010:0b011;
+		CHECK(prescaler > first);
+		CHECK(prescaler < 7);
+		CHECK(noiseAt(prescaler) < noiseAt(first));
+	}
+}
+
+int main(){
+	testDefaults();
+	testNoisyClock();
+
+	return checkReport("test_prescaler");
+}
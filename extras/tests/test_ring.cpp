@@ -0,0 +1,109 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Unit tests of CapADCRing: empty and full states, order, wrap around of the 8 bits indexes.
+
+#include "check.h"
+#include "CapADCSim.h"
+#include "CapacitiveADCScanner.h"
+
+static void testEmpty(){
+	CapADCRing<uint16_t, 8> ring;
+	uint16_t value = 0;
+
+	CHECK(ring.isEmpty());
+	CHECK_EQUAL(ring.available(), 0);
+
+	CHECK(ring.push(0xbeef));
+	CHECK(!ring.isEmpty());
+	CHECK(ring.pop(value));
+	CHECK_EQUAL(value, 0xbeef);
+
+	// An empty ring leaves the value untouched.
+	CHECK(!ring.pop(value));
+	CHECK_EQUAL(value, 0xbeef);
+	CHECK(ring.isEmpty());
+}
+
+static void testFull(){
+	CapADCRing<uint16_t, 8> ring;
+
+	for(uint16_t i = 0; i < 8; ++i){
+		CHECK(ring.push(i));
+	}
+	CHECK_EQUAL(ring.available(), 8);
+	// A full ring refuses the value, and keeps the stored ones.
+	CHECK(!ring.push(100));
+	CHECK_EQUAL(ring.available(), 8);
+
+	uint16_t value = 0;
+	for(uint16_t i = 0; i < 8; ++i){
+		CHECK(ring.pop(value));
+		CHECK_EQUAL(value, i);
+	}
+	CHECK(ring.isEmpty());
+}
+
+// Indexes are free running 8 bits counters: go round them several times, at every fill level.
+static void testWrap(){
+	CapADCRing<uint8_t, 128> ring;
+	uint8_t in = 0, out = 0;
+
+	for(uint16_t round = 0; round < 1000; ++round){
+		uint8_t count = round % 129;
+		for(uint8_t i = 0; i < count; ++i){
+			CHECK(ring.push(in++));
+		}
+		CHECK_EQUAL(ring.available(), count);
+
+		uint8_t value = 0;
+		while(ring.pop(value)){
+			if(value != out) break;
+			++out;
+		}
+		CHECK_EQUAL(in, out);
+		CHECK(ring.isEmpty());
+	}
+}
+
+static void testClear(){
+	CapADCRing<CapADCSample_t, 4> ring;
+	CapADCSample_t sample = {1, -12};
+
+	ring.push(sample);
+	ring.push(sample);
+	ring.clear();
+	CHECK(ring.isEmpty());
+
+	sample.index = 3;
+	sample.value = 512;
+	CHECK(ring.push(sample));
+	CapADCSample_t value = {0, 0};
+	CHECK(ring.pop(value));
+	CHECK_EQUAL(value.index, 3);
+	CHECK_EQUAL(value.value, 512);
+}
+
+int main(){
+	testEmpty();
+	testFull();
+	testWrap();
+	testClear();
+
+	return checkReport("test_ring");
+}
@@ -0,0 +1,167 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Tests of CapADCScanner on the simulator: results, per channel slots, scan period whatever
+// the loop does, overruns when the loop doesn't poll, and the ADC and delay timer handed back by end().
+
+#include "check.h"
+#include "CapADCSim.h"
+#include "CapacitiveADCScanner.h"
+
+#include <stdlib.h>
+
+static CapADCChannel channel[2];
+
+// Poll the scanner for us microseconds of virtual time, every interval us.
+static void pollFor(uint32_t us, uint32_t interval = 50){
+	uint64_t end = CapADCSim::cycles() + (uint64_t)us * (F_CPU / 1000000);
+	while(CapADCSim::cycles() < end){
+		CapADCScanner::poll();
+		CapADCSim::run(interval);
+	}
+}
+
+static bool waitComplete(uint32_t us){
+	uint64_t end = CapADCSim::cycles() + (uint64_t)us * (F_CPU / 1000000);
+	while(CapADCSim::cycles() < end){
+		if(CapADCScanner::isComplete()) return true;
+		CapADCSim::run(50);
+	}
+	return false;
+}
+
+// A scan gives the sum of slots reads of every channel, as blocking reads would.
+static void testResults(){
+	int16_t single[2];
+	for(uint8_t i = 0; i < 2; ++i){
+		single[i] = channel[i].read();
+	}
+	CHECK(single[0] > single[1] + 50);
+
+	CapADCScanner::begin(4);
+	CHECK(CapADCScanner::isRunning());
+	CHECK(waitComplete(10000));
+	for(uint8_t i = 0; i < 2; ++i){
+		CHECK(abs(CapADCScanner::getResult(i) - 4 * single[i]) <= 8);
+	}
+	CHECK_EQUAL(CapADCScanner::getOverruns(), 0);
+	CapADCScanner::end();
+	CHECK(!CapADCScanner::isRunning());
+}
+
+// Each channel gets its own number of reads per scan, the scan lasting as long as the most read one.
+static void testSlots(){
+	int16_t single[2];
+	for(uint8_t i = 0; i < 2; ++i){
+		single[i] = channel[i].read();
+	}
+
+	CHECK(CapADCScanner::setSlots(1, 3));
+	CHECK(!CapADCScanner::setSlots(2, 3));
+	CapADCScanner::begin(1);
+	CHECK_EQUAL(CapADCScanner::getSlots(0), 1);
+	CHECK_EQUAL(CapADCScanner::getSlots(1), 3);
+	CHECK(!CapADCScanner::setSlots(1, 2));
+
+	CHECK(waitComplete(10000));
+	CHECK(waitComplete(10000));
+	CHECK(abs(CapADCScanner::getResult(0) - single[0]) <= 2);
+	CHECK(abs(CapADCScanner::getResult(1) - 3 * single[1]) <= 6);
+	CapADCScanner::end();
+
+	CHECK(CapADCScanner::setSlots(1, 0));
+	CHECK_EQUAL(CapADCScanner::getSlots(1), CapADCScanner::getSlots(0));
+}
+
+// Scans start once per period, from the delay timer, however fast or slow the loop polls,
+// as long as the ring holds the reads between two polls.
+static void testPeriod(){
+	static const uint32_t intervals[3] = {50, 5000, 15000};
+
+	for(uint8_t i = 0; i < 3; ++i){
+		CapADCScanner::begin(2, 5000);
+		pollFor(10000, intervals[i]);
+		uint32_t count = CapADCScanner::getScanCount();
+		pollFor(1000000, intervals[i]);
+		count = CapADCScanner::getScanCount() - count;
+
+		CHECK(count >= 199 && count <= 201);
+		CHECK(abs((int32_t)CapADCScanner::getScanTime() - 5000) < 100);
+		CHECK(CapADCScanner::getScanRate() >= 199 && CapADCScanner::getScanRate() <= 200);
+		CHECK_EQUAL(CapADCScanner::getOverruns(), 0);
+		CapADCScanner::end();
+	}
+}
+
+// A loop not polling pauses the scanner when the ring is full, without losing any read.
+static void testOverruns(){
+	CapADCScanner::begin(1);
+	CapADCSim::run(100000);
+
+	uint32_t conversions = CapADCSim::getConversions();
+	CapADCSim::run(10000);
+	CHECK_EQUAL(CapADCSim::getConversions(), conversions);
+	CHECK(CapADCScanner::getOverruns() > 0);
+	CHECK_EQUAL(CapADCScanner::getScanCount(), CAP_ADC_SCAN_RING_SIZE / 2);
+
+	// Polling drains the ring and resumes the scans.
+	CHECK(CapADCScanner::isComplete());
+	pollFor(10000);
+	CHECK(CapADCSim::getConversions() > conversions);
+	CHECK(CapADCScanner::getScanCount() > CAP_ADC_SCAN_RING_SIZE / 2);
+	CapADCScanner::end();
+}
+
+// The ADC belongs to the scanner while it runs, and the delay timer is given back after.
+static void testOwnership(){
+	uint8_t tccra = TCCR2A, tccrb = TCCR2B, ocr = OCR2A, timsk = TIMSK2;
+
+	CapADCScanner::begin(1);
+	CHECK(TCCR2A != tccra || TCCR2B != tccrb);
+	CHECK_EQUAL(channel[0].read(), 0);
+	CHECK_EQUAL(channel[0].calibratePrescaler(4), 0);
+	pollFor(10000);
+	CapADCScanner::end();
+
+	CHECK(!CapADCChannel::isBusy());
+	CHECK_EQUAL(TCCR2A, tccra);
+	CHECK_EQUAL(TCCR2B, tccrb);
+	CHECK_EQUAL(OCR2A, ocr);
+	CHECK_EQUAL(TIMSK2, timsk);
+	CHECK(channel[0].read() > 0);
+}
+
+int main(){
+	CapADCSim::reset();
+	CapADCSim::setNoise(0);
+	CapADCSim::setElectrode(A0, 20);
+	CapADCSim::setElectrode(A2, 10);
+
+	channel[0].init(A0, A1);
+	channel[1].init(A2, A3);
+	CHECK_EQUAL(CapADCScanner::add(&channel[0]), 0);
+	CHECK_EQUAL(CapADCScanner::add(&channel[1]), 1);
+
+	testResults();
+	testSlots();
+	testPeriod();
+	testOverruns();
+	testOwnership();
+
+	return checkReport("test_scanner");
+}
@@ -0,0 +1,87 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Tests of sleep reads on the simulator, with a digital noise on samples taken while the CPU runs:
+// reads sleeping through their conversions are quieter, by a measured number of averaged reads.
+
+#include <math.h>
+
+#include "check.h"
+#include "CapADCSim.h"
+#include "CapacitiveADCChannel.h"
+
+static CapADCChannel channel;
+
+// Standard deviation of reads, each the average of samples reads.
+static double deviation(uint8_t samples, uint16_t count){
+	double sum = 0;
+	double squares = 0;
+	for(uint16_t i = 0; i < count; ++i){
+		int32_t value = 0;
+		for(uint8_t j = 0; j < samples; ++j){
+			value += channel.read();
+		}
+		double mean = (double)value / samples;
+		sum += mean;
+		squares += mean * mean;
+	}
+	sum /= count;
+	return sqrt(squares / count - sum * sum);
+}
+
+// Sleep reads start their conversions from the sleep instruction: every sample is taken asleep.
+static void testConversions(){
+	channel.setSleepRead(true);
+	CHECK(channel.read() < 0);
+	uint32_t conversions = CapADCSim::getConversions();
+	uint32_t interrupts = CapADCSim::getInterrupts();
+	channel.read();
+	CHECK_EQUAL(CapADCSim::getConversions() - conversions, 2);
+	CHECK_EQUAL(CapADCSim::getInterrupts() - interrupts, 2);
+	channel.setSleepRead(false);
+}
+
+// Sleep reads are quieter, as much as several awake reads averaged.
+static void testNoise(){
+	channel.setSleepRead(false);
+	double awake = deviation(1, 400);
+	channel.setSleepRead(true);
+	double asleep = deviation(1, 400);
+
+	// Smallest number of awake reads averaged as quiet as one sleep read.
+	channel.setSleepRead(false);
+	uint8_t samples = 1;
+	while(samples < 32 && deviation(samples, 200) > asleep) ++samples;
+
+	printf("test_sleep: deviation %.2f awake, %.2f asleep, %u awake reads for one asleep, %u saved\n",
+			awake, asleep, samples, samples - 1);
+	CHECK(asleep < awake / 2);
+	CHECK(samples >= 4);
+	CHECK(samples < 32);
+}
+
+int main(){
+	CapADCSim::reset();
+	CapADCSim::setDigitalNoise(1.5);
+	channel.init(A0, A1);
+
+	testConversions();
+	testNoise();
+
+	return checkReport("test_sleep");
+}
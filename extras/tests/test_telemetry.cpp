@@ -0,0 +1,120 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Telemetry frames on the simulator, for telemetry_pty.py: records frames of known values,
+// writes what the serial port got to STREAM, and the CSV capadc_telemetry.py must decode
+// from it to EXPECTED. Built with telemetry on, for the whole build.
+// Usage: test_telemetry STREAM EXPECTED
+
+#include <stdio.h>
+
+#include "check.h"
+#include "CapADCSim.h"
+#include "CapacitiveADCTelemetry.h"
+
+static const char *States[] = {"idle", "baseline", "rising", "falling", "prox", "touch"};
+
+// Time stamp of the last frame recorded, read back from the buffer.
+class TelemetryProbe: public CapADCTelemetry{
+public:
+	static uint16_t lastTime(){
+		// The frame ends with the time, 4 values and the checksum.
+		uint8_t at = (_head - 11) & (CAP_ADC_TELEMETRY_SIZE - 1);
+		return _buffer[at] | (_buffer[(at + 1) & (CAP_ADC_TELEMETRY_SIZE - 1)] << 8);
+	}
+};
+
+static uint32_t seed = 1;
+
+static uint16_t next(){
+	seed = seed * 1103515245 + 12345;
+	return seed >> 16;
+}
+
+int main(int argc, char **argv){
+	if(argc < 3){
+		fprintf(stderr, "usage: test_telemetry STREAM EXPECTED\n");
+		return 2;
+	}
+
+	FILE *expected = fopen(argv[2], "w");
+	if(!expected){
+		perror(argv[2]);
+		return 2;
+	}
+	fprintf(expected, "time,id,state,raw,filtered,baseline,delta\n");
+
+	CapADCSim::reset();
+	CHECK(!CapADCTelemetry::record(0, 0, 0, 0, 0, 0));
+
+	CapADCTelemetry::begin(Serial);
+
+	// Frames spread over two minutes, so the 16 bits time wraps, with a long silence
+	// and bursts recorded without sending, that fill the buffer.
+	uint32_t first = 0;
+	uint16_t recorded = 0;
+	uint16_t dropped = 0;
+	for(uint16_t i = 0; i < 1200; ++i){
+		uint8_t id = (i % 50 == 7)?254:next() % 8;
+		uint8_t state = next() % 7;
+		uint16_t raw = next() & 0x3ff;
+		uint16_t filtered = next() & 0x3ff;
+		uint16_t baseline = next() & 0x3ff;
+		int16_t delta = (int16_t)filtered - (int16_t)baseline;
+
+		uint32_t before = millis();
+		if(CapADCTelemetry::record(id, state, raw, filtered, baseline, delta)){
+			uint32_t time = before + (uint16_t)(TelemetryProbe::lastTime() - (uint16_t)before);
+			if(!recorded) first = time;
+			++recorded;
+
+			fprintf(expected, "%lu,%u,", (unsigned long)(time - first), id);
+			if(state < sizeof(States) / sizeof(States[0])){
+				fprintf(expected, "%s", States[state]);
+			} else {
+				fprintf(expected, "%u", state);
+			}
+			fprintf(expected, ",%u,%u,%u,%d\n", raw, filtered, baseline, delta);
+		} else {
+			++dropped;
+		}
+
+		if(i % 100 >= 12) CapADCTelemetry::send();
+		delay((i == 600)?60000:next() % 100);
+	}
+
+	for(uint8_t i = 0; i < 4; ++i){
+		CapADCTelemetry::send();
+	}
+	fclose(expected);
+
+	CHECK(dropped > 0);
+	CHECK_EQUAL(CapADCTelemetry::getDropped(), dropped);
+	CHECK_EQUAL(CapADCSim::serial().size(), recorded * CapADCTelemetry::FrameSize);
+	CHECK(millis() > 0x10000);
+
+	FILE *stream = fopen(argv[1], "wb");
+	if(!stream){
+		perror(argv[1]);
+		return 2;
+	}
+	fwrite(CapADCSim::serial().data(), 1, CapADCSim::serial().size(), stream);
+	fclose(stream);
+
+	return checkReport("test_telemetry");
+}
@@ -0,0 +1,119 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Tests of the wheel angle against a floating point reference: the exact arc tangent of the sum of
+// the directions of the strongest segment and its neighbours, weighted by their deltas.
+// Fingers sweep the turn, with noise on every segment, over wheels of 3, 6 and 12 segments.
+
+#include <math.h>
+
+#include "check.h"
+#include "CapADCSim.h"
+#include "CapacitiveADCWheel.h"
+
+// A wheel computing its angle from given deltas.
+template<uint8_t Segments>
+class TestWheel: public CapADCWheel<Segments>{
+public:
+	uint16_t angle(const int16_t *deltas){
+		for(uint8_t i = 0; i < Segments; ++i){
+			this->_segment[i].delta = deltas[i];
+		}
+		this->_segment[Segments].state = CapADC::Touch;
+		this->_segment[Segments].previousState = CapADC::Touch;
+		this->updatePosition();
+		return this->getAngle();
+	}
+};
+
+static uint32_t seed = 1;
+
+static int16_t noise(){
+	seed = seed * 1103515245 + 12345;
+	return (int16_t)((seed >> 16) % 7) - 3;
+}
+
+// Exact angle of the deltas, a full turn being 65536.
+static double reference(const int16_t *deltas, uint8_t segments){
+	uint8_t strongest = 0;
+	for(uint8_t i = 1; i < segments; ++i){
+		if(deltas[i] > deltas[strongest]) strongest = i;
+	}
+
+	double x = 0;
+	double y = 0;
+	for(int8_t n = -1; n <= 1; ++n){
+		uint8_t i = (strongest + segments + n) % segments;
+		if(deltas[i] <= 0) continue;
+		x += cos(2 * M_PI * i / segments) * deltas[i];
+		y += sin(2 * M_PI * i / segments) * deltas[i];
+	}
+
+	double angle = atan2(y, x) / (2 * M_PI) * 65536;
+	return (angle < 0)?(angle + 65536):angle;
+}
+
+// Distance between two angles, around the turn.
+static double distance(double a, double b){
+	return fabs(fmod(a - b + 65536 * 1.5, 65536) - 32768);
+}
+
+// A finger a segment wide at angle: each segment sees it by how much they overlap, plus noise.
+static void touch(int16_t *deltas, uint8_t segments, double angle, int16_t amplitude){
+	for(uint8_t i = 0; i < segments; ++i){
+		double overlap = 1 - distance(angle, 65536.0 * i / segments) * segments / 65536;
+		deltas[i] = ((overlap > 0)?(int16_t)(amplitude * overlap):0) + noise();
+	}
+}
+
+template<uint8_t Segments>
+static void testSegments(){
+	static const int16_t amplitudes[] = {30, 300, 3000};
+	TestWheel<Segments> wheel;
+	int16_t deltas[Segments];
+
+	// Within 5/65536 of a turn of the exact angle.
+	double worst = 0;
+	for(uint8_t a = 0; a < 3; ++a){
+		for(uint32_t angle = 0; angle < 65536; angle += 97){
+			touch(deltas, Segments, angle, amplitudes[a]);
+			double error = distance(wheel.angle(deltas), reference(deltas, Segments));
+			if(worst < error) worst = error;
+		}
+	}
+	printf("test_wheel: %u segments, worst error %.2f / 65536\n", Segments, worst);
+	CHECK(worst <= 5);
+
+	// A second, lighter finger away from the first one doesn't pull the angle.
+	if(Segments >= 5){
+		touch(deltas, Segments, 65536.0 / (4 * Segments), 300);
+		uint16_t alone = wheel.angle(deltas);
+		deltas[Segments / 2] += 200;
+		CHECK_EQUAL(wheel.angle(deltas), alone);
+	}
+}
+
+int main(){
+	CapADCSim::reset();
+
+	testSegments<3>();
+	testSegments<6>();
+	testSegments<12>();
+
+	return checkReport("test_wheel");
+}
@@ -0,0 +1,32 @@
+/*
+ * This Arduino library is for using Arduino pins as capacitives pins, using ADC.
+ * Copyright (C) 2017  Pierre-Loup Martin
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Stands for Tone.cpp, that defines the timer 2 compare interrupt as tone() needs it.
+// Linked with the library using timer 2 as delay timer, this must fail: see CAP_ADC_DELAY_TIMER.
+
+#include "CapADCSim.h"
+#include "CapacitiveADCChannel.h"
+
+ISR(TIMER2_COMPA_vect){
+}
+
+int main(){
+	CapADCChannel channel;
+	channel.init(A0, A1);
+	return channel.read() != 0;
+}